@@ -0,0 +1,173 @@
+// Alarm table: each alarm is an absolute expiry tick (TimerNow() time). The running alarms are kept in a
+// fixed size binary min-heap ordered by expiry, so the nearest alarm is always Heap[0] and adding, changing
+// or cancelling an alarm is O(log n). Position[] maps an alarm id to its heap index so that an alarm can be
+// changed or cancelled by id. Expiry ticks are compared by signed difference so the 32 bit wrap is harmless.
+
+#include "alarmrtns.h"
+
+// True if expiry1 is before expiry2
+#define BEFORE(expiry1, expiry2)    ((int32_t)((expiry1) - (expiry2)) < 0)
+
+static uint32_t Expiry[ALARM_COUNT];        // by id
+static uint8_t  Position[ALARM_COUNT];      // by id; heap index or ALARM_NONE if not running
+static uint8_t  Heap[ALARM_COUNT];          // ids
+static uint32_t HeapSize;
+
+// Ids not in use, as a stack
+static uint8_t  FreeIds[ALARM_COUNT];
+static uint32_t FreeCount;
+
+// Incremented by every add, change and cancel; see AlarmChanges()
+static uint32_t Changes;
+
+static void swap(const uint32_t i,
+                 const uint32_t j);
+static void siftUp(uint32_t i);
+static void siftDown(uint32_t i);
+
+void AlarmInit(void)
+{
+    uint32_t id;
+
+    for (id = 0; id < ALARM_COUNT; id++)
+    {
+        Position[id] = ALARM_NONE;
+        FreeIds[id] = (uint8_t)(ALARM_COUNT - 1 - id);  // hand out id 0 first
+    }
+    FreeCount = ALARM_COUNT;
+    HeapSize = 0;
+}
+
+// Returns the new alarm's id, or ALARM_NONE if all ALARM_COUNT alarms are running.
+uint32_t AlarmAdd(const uint32_t expiry)
+{
+    uint32_t id;
+
+    if (FreeCount == 0)
+        return ALARM_NONE;
+
+    id = FreeIds[--FreeCount];
+    Expiry[id] = expiry;
+    Heap[HeapSize] = (uint8_t)id;
+    Position[id] = (uint8_t)HeapSize;
+    HeapSize++;
+    siftUp(Position[id]);
+    Changes++;
+
+    return id;
+}
+
+void AlarmSet(const uint32_t id,
+              const uint32_t expiry)
+{
+    uint32_t earlier;
+
+    if (!AlarmActive(id))
+        return;
+
+    earlier = BEFORE(expiry, Expiry[id]);
+    Expiry[id] = expiry;
+
+    if (earlier)
+        siftUp(Position[id]);
+    else
+        siftDown(Position[id]);
+    Changes++;
+}
+
+void AlarmCancel(const uint32_t id)
+{
+    uint32_t i;
+
+    if (!AlarmActive(id))
+        return;
+
+    // Move the last heap entry into the hole, then restore the heap in whichever direction it needs
+    i = Position[id];
+    HeapSize--;
+    if (i != HeapSize)
+    {
+        uint32_t moved = Heap[HeapSize];
+
+        swap(i, HeapSize);
+        siftUp(i);
+        siftDown(Position[moved]);
+    }
+
+    Position[id] = ALARM_NONE;
+    FreeIds[FreeCount++] = (uint8_t)id;
+    Changes++;
+}
+
+uint32_t AlarmActive(const uint32_t id)
+{
+    return id < ALARM_COUNT && Position[id] != ALARM_NONE;
+}
+
+uint32_t AlarmExpiry(const uint32_t id)
+{
+    return Expiry[id];
+}
+
+// Returns the id of the alarm that expires first, or ALARM_NONE.
+uint32_t AlarmNearest(void)
+{
+    return HeapSize != 0 ? Heap[0] : ALARM_NONE;
+}
+
+uint32_t AlarmCount(void)
+{
+    return HeapSize;
+}
+
+// Changes since AlarmInit(); compare two values to tell whether the alarms have changed in between
+uint32_t AlarmChanges(void)
+{
+    return Changes;
+}
+
+static void swap(const uint32_t i,
+                 const uint32_t j)
+{
+    uint8_t id = Heap[i];
+
+    Heap[i] = Heap[j];
+    Heap[j] = id;
+    Position[Heap[i]] = (uint8_t)i;
+    Position[Heap[j]] = (uint8_t)j;
+}
+
+static void siftUp(uint32_t i)
+{
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+
+        if (!BEFORE(Expiry[Heap[i]], Expiry[Heap[parent]]))
+            break;
+
+        swap(i, parent);
+        i = parent;
+    }
+}
+
+static void siftDown(uint32_t i)
+{
+    while (1)
+    {
+        uint32_t smallest = i;
+        uint32_t left = 2 * i + 1;
+        uint32_t right = left + 1;
+
+        if (left < HeapSize && BEFORE(Expiry[Heap[left]], Expiry[Heap[smallest]]))
+            smallest = left;
+        if (right < HeapSize && BEFORE(Expiry[Heap[right]], Expiry[Heap[smallest]]))
+            smallest = right;
+
+        if (smallest == i)
+            break;
+
+        swap(i, smallest);
+        i = smallest;
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef ALARMRTNS_H
+#define ALARMRTNS_H
+
+#include "stdint.h"
+
+// Number of alarms that can run at the same time; ids are 0 .. ALARM_COUNT - 1
+#define ALARM_COUNT             8
+#define ALARM_NONE              0xFF
+
+void AlarmInit                  (void);
+uint32_t AlarmAdd               (const uint32_t expiry);
+void AlarmSet                   (const uint32_t id,
+                                 const uint32_t expiry);
+void AlarmCancel                (const uint32_t id);
+uint32_t AlarmActive            (const uint32_t id);
+uint32_t AlarmExpiry            (const uint32_t id);
+uint32_t AlarmNearest           (void);
+uint32_t AlarmCount             (void);
+uint32_t AlarmChanges           (void);
+
+#endif // ALARMRTNS_H
@@ -0,0 +1,226 @@
+// Latency benchmark: switch edge to the first character of the display update.
+//
+// BenchStep() runs from a software timer. It presses a switch with InputInject(), which triggers GPIOF_Handler
+// from software (NVIC STIR) and makes the pin read pressed, then releases it BENCH_HOLD later. The press takes
+// the real path: GPIOF_Handler, the debounce on WTimer0B, the event queue, the state machine and the display.
+// The measurement starts at BenchEdge(), called by GPIOF_Handler for the first edge of the press. BenchPressed()
+// is called by InputDebounceHandler() as it queues the press, and BenchFrameQueued() by ScreenTime() just before
+// it writes the new frame to the UART0 transmit ring. The measurement stops at BenchTransmit(), called by the
+// UART0 driver as the first character of that frame is written to UARTDR (or handed to the uDMA). Each press is
+// counted twice: from the edge, and from BenchPressed(), which leaves out the fixed INPUT_DEBOUNCE_TIME.
+//
+// Presses alternate between SW2 and SW1 after two SW2 presses, so the selected alarm moves between 0:01 and
+// 0:02 and every press changes the frame. A press that produces no frame before the next one counts as lost.
+//
+// Latencies are measured on the DWT cycle counter and converted with ClockHz(); main.c leaves CLOCK_BURST
+// undefined in a benchmark build so that the clock does not change under a measurement. Every BENCH_SAMPLES
+// presses the histograms, the lost presses and the event queue and UART0 counters are sent, one row at a time
+// as the DIAG_BENCH channel has room (see ProfService()), and the histogram is cleared.
+
+#include "TM4C123GH6PM.h"
+
+#include "benchrtns.h"
+#include "clockrtns.h"
+#include "diagrtns.h"
+#include "fmtrtns.h"
+#include "inputrtns.h"
+#include "profrtns.h"
+#include "queuertns.h"
+#include "uartrtns.h"
+
+#ifdef BENCHMARK
+
+// Rows of a report: the counters, then one per bucket
+#define BENCH_ROW_COUNTERS      0
+#define BENCH_ROW_FIRST_BUCKET  1
+#define BENCH_NOT_REPORTING     (BENCH_ROW_FIRST_BUCKET + BENCH_BUCKETS)
+
+// "lost" and five numbers, or "us" and three numbers; each with a leading space, "\n\r" and the NUL
+#define BENCH_ROW_SZ            (4 + 5 * FMT_UNSIGNED_SZ + 2 + 1)
+
+static uint32_t Histogram[BENCH_BUCKETS];           // from the edge
+static uint32_t Validated[BENCH_BUCKETS];           // from the end of the debounce
+static uint32_t Samples;
+static uint32_t Lost;
+static uint32_t Presses;                // synthetic presses since BenchInit()
+static uint32_t EdgeStart;              // CYCCNT at the first edge of the press being measured
+static uint32_t PressStart;             // CYCCNT when it was validated
+static uint32_t Pending;                // a press is waiting for its frame
+static uint32_t Edge;                   // its first edge has been seen
+static uint32_t Pressed;                // it has been validated
+static uint32_t Queued;                 // its frame is in the transmit ring, from FrameFirst
+static uint32_t FrameFirst;
+static uint32_t Held;                   // id of the switch held down, 0 if none
+static uint32_t Reporting = BENCH_NOT_REPORTING;    // next row to send
+
+static void addSample(uint32_t * const histogram,
+                      const uint32_t cycles);
+static uint32_t finishReport(void);
+
+void BenchInit(void)
+{
+    CoreDebug->DEMCR |= DEMCR_TRCENA;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+// Called from a timer callback; returns the milliseconds until it wants to be called again
+uint32_t BenchStep(void)
+{
+    uint32_t id;
+
+    if (Held)
+    {
+        InputInject(Held, 0);
+        Held = 0;
+        return BENCH_INTERVAL - BENCH_HOLD;
+    }
+
+    // Hold off while a report is being sent so that it does not delay the frames being measured
+    if (Reporting != BENCH_NOT_REPORTING)
+        return BENCH_INTERVAL;
+
+    if (Pending)
+        Lost++;
+
+    id = (Presses < 2 || (Presses & 1)) ? SWITCH_2 : SWITCH_1;
+    Presses++;
+
+    Pending = 1;
+    Edge    = 0;
+    Pressed = 0;
+    Queued  = 0;
+    InputInject(id, 1);
+    Held = id;
+
+    return BENCH_HOLD;
+}
+
+// Called by GPIOF_Handler on entry; the first call after a synthetic press is its first edge
+void BenchEdge(void)
+{
+    if (Pending && !Edge)
+    {
+        EdgeStart = DWT->CYCCNT;
+        Edge = 1;
+    }
+}
+
+// Called by InputDebounceHandler() when it queues a press
+void BenchPressed(void)
+{
+    if (Edge && !Pressed)
+    {
+        PressStart = DWT->CYCCNT;
+        Pressed = 1;
+    }
+}
+
+// Called by ScreenTime() before it writes a frame (or the changed part of one) to the UART0 transmit ring
+void BenchFrameQueued(void)
+{
+    if (Pressed && !Queued)
+    {
+        FrameFirst = UartTxQueued(UART_0);
+        Queued = 1;
+    }
+}
+
+// Called by the UART0 driver, with interrupts masked or from UART0_Handler, before it sends the characters
+// first to first + count - 1 of its transmit ring (see UartTxQueued())
+void BenchTransmit(const uint32_t first,
+                   const uint32_t count)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    if (!Queued || (int32_t)(first + count - FrameFirst) <= 0)
+        return;
+    Pending = 0;
+    Queued  = 0;
+
+    addSample(Histogram, now - EdgeStart);
+    addSample(Validated, now - PressStart);
+
+    if (++Samples == BENCH_SAMPLES)
+        Reporting = BENCH_ROW_COUNTERS;
+}
+
+// Called from the main loop; sends the next rows of a report. Returns 1 once the last row has been queued.
+//   lost <lost> <queue high water> <queue dropped> <tx dropped> <rx dropped>
+//   us <2^k> <count from the edge> <count from the end of the debounce>
+uint32_t BenchService(void)
+{
+    while (Reporting != BENCH_NOT_REPORTING)
+    {
+        char row[BENCH_ROW_SZ];
+        uint32_t length;
+
+        if (Reporting == BENCH_ROW_COUNTERS)
+        {
+            row[0] = 'l';
+            row[1] = 'o';
+            row[2] = 's';
+            row[3] = 't';
+            length = FmtAppendUnsigned(row, 4, Lost);
+            length = FmtAppendUnsigned(row, length, QueueHighWater());
+            length = FmtAppendUnsigned(row, length, QueueDropped());
+            length = FmtAppendUnsigned(row, length, UartTxDropped(UART_0));
+            length = FmtAppendUnsigned(row, length, UartRxDropped(UART_0));
+        }
+        else
+        {
+            uint32_t bucket = Reporting - BENCH_ROW_FIRST_BUCKET;
+
+            if (Histogram[bucket] == 0 && Validated[bucket] == 0)
+            {
+                if (++Reporting == BENCH_NOT_REPORTING)
+                    return finishReport();
+                continue;
+            }
+            row[0] = 'u';
+            row[1] = 's';
+            length = FmtAppendUnsigned(row, 2, 1UL << bucket);
+            length = FmtAppendUnsigned(row, length, Histogram[bucket]);
+            length = FmtAppendUnsigned(row, length, Validated[bucket]);
+        }
+        row[length++] = '\n';
+        row[length++] = '\r';
+        row[length] = '\0';
+
+        if (DiagSpace(DIAG_BENCH) < length)
+            return 0;
+        DiagWrite(DIAG_BENCH, row);
+
+        if (++Reporting == BENCH_NOT_REPORTING)
+            return finishReport();
+    }
+    return 0;
+}
+
+// Add a latency to a histogram
+static void addSample(uint32_t * const histogram,
+                      const uint32_t cycles)
+{
+    uint32_t micro = cycles / (ClockHz() / 1000000);
+    uint32_t bucket = (micro == 0) ? 0 : 31 - __CLZ(micro);
+
+    if (bucket >= BENCH_BUCKETS)
+        bucket = BENCH_BUCKETS - 1;
+    histogram[bucket]++;
+}
+
+// The last row has been queued: start the next set of samples
+static uint32_t finishReport(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < BENCH_BUCKETS; i++)
+    {
+        Histogram[i] = 0;
+        Validated[i] = 0;
+    }
+    Samples = 0;
+    Lost = 0;
+    return 1;
+}
+
+#endif // BENCHMARK
@@ -0,0 +1,27 @@
+#ifndef BENCHRTNS_H
+#define BENCHRTNS_H
+
+#include "stdint.h"
+
+// Define BENCHMARK for the latency benchmark build: synthetic switch presses are fed through GPIOF_Handler and
+// the time from the switch edge to the first character of the updated frame is reported over UART0, with and
+// without the debounce (see benchrtns.c).
+// #define BENCHMARK
+
+#define BENCH_INTERVAL          100     // milliseconds between synthetic presses
+#define BENCH_HOLD              50      // milliseconds a synthetic press is held; less than INPUT_LONG_PRESS
+#define BENCH_SAMPLES           200     // presses per report
+
+// Histogram bucket k counts latencies of 2^k to 2^(k+1) - 1 microseconds
+#define BENCH_BUCKETS           17
+
+void BenchInit                  (void);
+uint32_t BenchStep              (void);
+void BenchEdge                  (void);
+void BenchPressed               (void);
+void BenchFrameQueued           (void);
+void BenchTransmit              (const uint32_t first,
+                                 const uint32_t count);
+uint32_t BenchService           (void);
+
+#endif // BENCHRTNS_H
@@ -0,0 +1,210 @@
+// System clock profiles. See 5.3 Initialization and Configuration (PLL) and Register 8: RCC, Register 23: RCC2.
+// To use the PLL:
+// 1. Use RCC2 (USERCC2) and bypass the PLL (BYPASS2) while it is being configured.
+// 2. Select the crystal value (RCC XTAL) and oscillator source (RCC2 OSCSRC2), and clear PWRDN2.
+// 3. Select the system divider (DIV400, SYSDIV2, SYSDIV2LSB) and set USESYSDIV.
+// 4. Wait for the PLL to lock (RIS PLLLRIS), then clear BYPASS2.
+// RIS PLLLRIS and MOSCPUPRIS are latched: they stay set from the last lock and power up until written to MISC,
+// so they are cleared before each start of the oscillator or the PLL, and only a new event sets them again.
+// Peripherals that depend on the system clock are updated here: the UART baud rate divisors and the led PWM
+// period. Wide Timer 0 runs from PIOSC (see timerrtns.c) so the millisecond tick, and with it the debounce and
+// delay times, do not change.
+// ClockRead() works the frequency out from the registers instead of the profile, as the driverlib's
+// SysCtlClockGet() does, so that nothing has to be linked in to check the clock tree.
+
+#include "TM4C123GH6PM.h"
+
+#include "clockrtns.h"
+#include "diagrtns.h"
+#include "ledrtns.h"
+#include "uartrtns.h"
+
+// RCC
+#define RCC_MOSCDIS             (1U << 0)
+#define RCC_OSCSRC_M            (0x3U << 4)
+#define RCC_XTAL_M              (0x1FU << 6)
+#define RCC_XTAL_16MHZ          (0x15U << 6)
+#define RCC_BYPASS              (1U << 11)
+#define RCC_USESYSDIV           (1U << 22)
+#define RCC_SYSDIV_M            (0xFU << 23)
+
+// RCC2
+#define RCC2_OSCSRC2_M          (0x7U << 4)
+#define RCC2_OSCSRC2_MOSC       (0x0U << 4)
+#define RCC2_OSCSRC2_PIOSC      (0x1U << 4)
+#define RCC2_BYPASS2            (1U << 11)
+#define RCC2_PWRDN2             (1U << 13)
+#define RCC2_SYSDIV2_M          (0x7FU << 22)   // SYSDIV2 with SYSDIV2LSB
+#define RCC2_SYSDIV2_6_M        (0x3FU << 23)   // SYSDIV2 alone
+#define RCC2_DIV400             (1U << 30)
+#define RCC2_USERCC2            (1U << 31)
+
+// RIS; write 1 to MISC to clear
+#define RIS_PLLLRIS             (1U << 6)
+#define RIS_MOSCPUPRIS          (1U << 8)
+
+// PLLFREQ0, PLLFREQ1
+#define PLLFREQ0_MINT_M         (0x3FFU << 0)
+#define PLLFREQ0_MFRAC_M        (0x3FFU << 10)
+#define PLLFREQ1_N_M            (0x1FU << 0)
+#define PLLFREQ1_Q_M            (0x1FU << 8)
+
+// OSCSRC (RCC) and OSCSRC2 (RCC2) values
+#define OSCSRC_MOSC             0
+#define OSCSRC_PIOSC            1
+#define OSCSRC_PIOSC_4          2
+#define OSCSRC_LFIOSC           3
+#define OSCSRC_32KHZ            7               // RCC2 only: the Hibernation module oscillator
+
+#define PIOSC_HZ                16000000
+#define LFIOSC_HZ               30000           // nominal; 10 to 90kHz
+#define HIB_OSC_HZ              32768
+
+// Crystal frequency by RCC XTAL value, from 0x06 (see Register 8: RCC); the lower values are reserved
+#define XTAL_FIRST              0x06
+#define XTAL_COUNT              21
+
+static const uint32_t Crystals[XTAL_COUNT] =
+{
+    4000000, 4096000, 4915200, 5000000, 5120000, 6000000, 6144000, 7372800, 8000000, 8192000, 10000000,
+    12000000, 12288000, 13560000, 14318180, 16000000, 16384000, 18000000, 20000000, 24000000, 25000000
+};
+
+// 400MHz / (4 + 1) = 80MHz, with DIV400 and SYSDIV2LSB the divisor is written as 4 into RCC2[28:22]
+#define SYSDIV2_80MHZ           (4U << 22)
+
+static clock_profile_t Profile = CLOCK_16MHZ;
+
+void ClockSetProfile(const clock_profile_t profile)
+{
+    if (profile == Profile)
+        return;
+
+    // 1. Run from the raw oscillator while switching
+    SYSCTL->RCC2 |= RCC2_USERCC2 | RCC2_BYPASS2;
+
+    if (profile == CLOCK_80MHZ)
+    {
+        // Start the main oscillator (the LaunchPad has a 16MHz crystal) and wait for it to power up
+        SYSCTL->MISC = RIS_PLLLRIS | RIS_MOSCPUPRIS;
+        SYSCTL->RCC &= ~RCC_MOSCDIS;
+        while ((SYSCTL->RIS & RIS_MOSCPUPRIS) == 0);
+
+        // 2. The PLL relocks after PWRDN2 is cleared and after SYSDIV2 changes; only that lock may end step 4
+        SYSCTL->RCC  = (SYSCTL->RCC & ~RCC_XTAL_M) | RCC_XTAL_16MHZ;
+        SYSCTL->RCC2 = (SYSCTL->RCC2 & ~RCC2_OSCSRC2_M) | RCC2_OSCSRC2_MOSC;
+        SYSCTL->MISC = RIS_PLLLRIS;
+        SYSCTL->RCC2 &= ~RCC2_PWRDN2;
+
+        // 3.
+        SYSCTL->RCC2 = (SYSCTL->RCC2 & ~RCC2_SYSDIV2_M) | RCC2_DIV400 | SYSDIV2_80MHZ;
+        SYSCTL->RCC |= RCC_USESYSDIV;
+
+        // 4.
+        while ((SYSCTL->RIS & RIS_PLLLRIS) == 0);
+        SYSCTL->RCC2 &= ~RCC2_BYPASS2;
+    }
+    else
+    {
+        // Undivided PIOSC, then stop the PLL and the main oscillator
+        SYSCTL->RCC2 = (SYSCTL->RCC2 & ~RCC2_OSCSRC2_M) | RCC2_OSCSRC2_PIOSC;
+        SYSCTL->RCC &= ~RCC_USESYSDIV;
+        SYSCTL->MISC = RIS_PLLLRIS | RIS_MOSCPUPRIS;
+        SYSCTL->RCC2 |= RCC2_PWRDN2;
+        SYSCTL->RCC |= RCC_MOSCDIS;
+    }
+
+    Profile = profile;
+
+    UartSetClock(profile);
+    DiagSetClock(profile);
+    LedSetClock(ClockHz());
+}
+
+clock_profile_t ClockProfile(void)
+{
+    return Profile;
+}
+
+uint32_t ClockHz(void)
+{
+    return (Profile == CLOCK_80MHZ) ? CLOCK_80MHZ_HZ : CLOCK_16MHZ_HZ;
+}
+
+// Decode the system clock from RCC, RCC2 (when USERCC2 is set) and PLLFREQ0/1 (see 5.2.5 Clock Control and
+// Table 5-5). Returns 0 for a reserved crystal value.
+uint32_t ClockRead(void)
+{
+    const uint32_t rcc  = SYSCTL->RCC;
+    const uint32_t rcc2 = SYSCTL->RCC2;
+    const uint32_t xtal = (rcc & RCC_XTAL_M) >> 6;
+    uint32_t source;
+    uint32_t bypass;
+    uint64_t clock;
+
+    if (rcc2 & RCC2_USERCC2)
+    {
+        source = (rcc2 & RCC2_OSCSRC2_M) >> 4;
+        bypass = rcc2 & RCC2_BYPASS2;
+    }
+    else
+    {
+        source = (rcc & RCC_OSCSRC_M) >> 4;
+        bypass = rcc & RCC_BYPASS;
+    }
+
+    switch (source)
+    {
+    case OSCSRC_MOSC:
+        clock = (xtal >= XTAL_FIRST && xtal < XTAL_FIRST + XTAL_COUNT) ? Crystals[xtal - XTAL_FIRST] : 0;
+        break;
+
+    case OSCSRC_PIOSC:
+        clock = PIOSC_HZ;
+        break;
+
+    case OSCSRC_PIOSC_4:
+        clock = PIOSC_HZ / 4;
+        break;
+
+    case OSCSRC_LFIOSC:
+        clock = LFIOSC_HZ;
+        break;
+
+    case OSCSRC_32KHZ:
+        clock = HIB_OSC_HZ;
+        break;
+
+    default:
+        clock = 0;
+        break;
+    }
+
+    if (!bypass)
+    {
+        // fVCO = fIN * (MINT + MFRAC / 1024) / ((Q + 1) * (N + 1)), i.e. 400MHz; without DIV400 the
+        // system divider is fed fVCO / 2
+        const uint32_t pllfreq0 = SYSCTL->PLLFREQ0;
+        const uint32_t pllfreq1 = SYSCTL->PLLFREQ1;
+        const uint32_t mint  = pllfreq0 & PLLFREQ0_MINT_M;
+        const uint32_t mfrac = (pllfreq0 & PLLFREQ0_MFRAC_M) >> 10;
+        const uint32_t n = pllfreq1 & PLLFREQ1_N_M;
+        const uint32_t q = (pllfreq1 & PLLFREQ1_Q_M) >> 8;
+
+        clock = clock * (mint * 1024 + mfrac) / (1024 * (q + 1) * (n + 1));
+        if ((rcc2 & (RCC2_USERCC2 | RCC2_DIV400)) != (RCC2_USERCC2 | RCC2_DIV400))
+            clock /= 2;
+    }
+
+    if (rcc & RCC_USESYSDIV)
+    {
+        if ((rcc2 & (RCC2_USERCC2 | RCC2_DIV400)) == (RCC2_USERCC2 | RCC2_DIV400))
+            clock /= ((rcc2 & RCC2_SYSDIV2_M) >> 22) + 1;
+        else if (rcc2 & RCC2_USERCC2)
+            clock /= ((rcc2 & RCC2_SYSDIV2_6_M) >> 23) + 1;
+        else
+            clock /= ((rcc & RCC_SYSDIV_M) >> 23) + 1;
+    }
+
+    return (uint32_t)clock;
+}
@@ -0,0 +1,21 @@
+#ifndef CLOCKRTNS_H
+#define CLOCKRTNS_H
+
+#include "stdint.h"
+
+typedef enum
+{
+    CLOCK_16MHZ = 0,            // PIOSC, PLL powered down (the reset state; CLOCK_SETUP = 0)
+    CLOCK_80MHZ                 // PLL from the 16MHz main oscillator
+} clock_profile_t;
+
+#define CLOCK_PROFILE_COUNT     2
+#define CLOCK_16MHZ_HZ          16000000UL
+#define CLOCK_80MHZ_HZ          80000000UL
+
+void ClockSetProfile            (const clock_profile_t profile);
+clock_profile_t ClockProfile    (void);
+uint32_t ClockHz                (void);
+uint32_t ClockRead              (void);
+
+#endif // CLOCKRTNS_H
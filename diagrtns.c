@@ -0,0 +1,157 @@
+// Diagnostic output backends. By default a channel is UART0: DiagSpace() and DiagWrite() are UartTxSpace() and
+// UartTxWrite(), and the dumps are interleaved with the display.
+//
+// With DIAG_ITM defined, channel n is ITM stimulus port n (see the ARMv7-M Architecture Reference Manual, C1.7
+// Instrumentation Trace Macrocell). A write is a store of four characters at a time to the port, which the ITM
+// sends out on SWO (PC3) as a software source packet; the display link is left alone. A port reads non zero
+// when its FIFO can take a store. DiagSpace() is 0 while it reads zero, so the dumps hold a row back rather
+// than lose it, and DiagDeferred() tells the caller to try again shortly: there is no interrupt to say the
+// FIFO has drained. Otherwise DiagSpace() is unlimited. DiagWrite() never waits: characters the FIFO cannot
+// take later in a row are dropped and counted (DiagDropped()), so the SWO baud set in the debugger must keep up
+// with the dumps. Nothing is sent, and nothing counted, unless the debugger has enabled the ITM (ITM TCR
+// ITMENA) and the port (ITM TER) and set up the TPIU for SWO; with uVision, tick the stimulus ports 0 to
+// DIAG_CHANNEL_COUNT - 1 in the Trace settings and give the core clock as 16MHz. A dump to a port that is not
+// enabled is discarded.
+//
+// The SWO bit clock is the core clock divided by TPIU ACPR + 1, so DiagSetClock() scales the divider the debugger
+// has set for 16MHz when ClockSetProfile() changes the system clock, to keep the baud the same.
+
+#include "TM4C123GH6PM.h"
+
+#include "diagrtns.h"
+#include "profrtns.h"
+#include "uartrtns.h"
+
+#ifdef DIAG_ITM
+
+#define ITM_TCR_ITMENA          (1UL << 0)
+
+static uint32_t Prescale16;                     // ACPR + 1 for 16MHz, as set by the debugger
+static uint32_t Dropped;
+static uint32_t Deferred;
+
+static uint32_t portEnabled(const diag_channel_t channel);
+
+// Call while the system clock is still 16MHz
+void DiagInit(void)
+{
+    CoreDebug->DEMCR |= DEMCR_TRCENA;
+    Prescale16 = TPI->ACPR + 1;
+}
+
+void DiagSetClock(const clock_profile_t profile)
+{
+    uint32_t prescale = Prescale16;
+
+    if (profile == CLOCK_80MHZ)
+        prescale *= CLOCK_80MHZ_HZ / CLOCK_16MHZ_HZ;
+    TPI->ACPR = prescale - 1;
+}
+
+// Characters that can be written without being dropped by the channel's own policy
+uint32_t DiagSpace(const diag_channel_t channel)
+{
+    if (portEnabled(channel) && ITM->PORT[channel].u32 == 0)
+    {
+        Deferred = 1;
+        return 0;
+    }
+    return 0xFFFFFFFF;
+}
+
+// Non zero, once, if DiagSpace() has held a row back since the last call
+uint32_t DiagDeferred(void)
+{
+    uint32_t deferred = Deferred;
+
+    Deferred = 0;
+    return deferred;
+}
+
+void DiagWrite(const diag_channel_t channel,
+               const char * string)
+{
+    volatile uint32_t * const port = &ITM->PORT[channel].u32;
+    uint32_t length = 0;
+    uint32_t word;
+    uint32_t i;
+
+    if (!portEnabled(channel))
+        return;
+
+    while (string[length])
+        length++;
+
+    // Whole words first, then the odd characters one byte store each; little endian, so the first character
+    // goes out first
+    for (i = 0; i + 4 <= length; i += 4)
+    {
+        word = (uint32_t)(uint8_t)string[i] |
+               ((uint32_t)(uint8_t)string[i + 1] << 8) |
+               ((uint32_t)(uint8_t)string[i + 2] << 16) |
+               ((uint32_t)(uint8_t)string[i + 3] << 24);
+        if (*port == 0)
+        {
+            Dropped += 4;
+            continue;
+        }
+        *port = word;
+    }
+    for (; i < length; i++)
+    {
+        if (*port == 0)
+        {
+            Dropped++;
+            continue;
+        }
+        ITM->PORT[channel].u8 = (uint8_t)string[i];
+    }
+}
+
+uint32_t DiagDropped(void)
+{
+    return Dropped;
+}
+
+static uint32_t portEnabled(const diag_channel_t channel)
+{
+    return (ITM->TCR & ITM_TCR_ITMENA) && (ITM->TER & (1UL << channel));
+}
+
+#else
+
+void DiagInit(void)
+{
+}
+
+void DiagSetClock(const clock_profile_t profile)
+{
+    (void)profile;
+}
+
+uint32_t DiagSpace(const diag_channel_t channel)
+{
+    (void)channel;
+    return UartTxSpace(UART_0);
+}
+
+// A dump held back for UART0 is resumed by its transmit interrupt
+uint32_t DiagDeferred(void)
+{
+    return 0;
+}
+
+void DiagWrite(const diag_channel_t channel,
+               const char * string)
+{
+    (void)channel;
+    UartTxWrite(UART_0, string);
+}
+
+// UART0 drops are counted by UartTxDropped()
+uint32_t DiagDropped(void)
+{
+    return 0;
+}
+
+#endif // DIAG_ITM
@@ -0,0 +1,32 @@
+#ifndef DIAGRTNS_H
+#define DIAGRTNS_H
+
+#include "stdint.h"
+
+#include "clockrtns.h"
+
+// Diagnostic output: the boot banner and the profiling, trace, memory and benchmark dumps. They share UART0
+// with the display unless DIAG_ITM is defined, in which case each goes to its own ITM stimulus port and out on
+// SWO (see diagrtns.c).
+// #define DIAG_ITM
+
+// The channels; with DIAG_ITM the stimulus port number
+typedef enum
+{
+    DIAG_BANNER = 0,
+    DIAG_PROFILE,
+    DIAG_TRACE,
+    DIAG_MEMORY,
+    DIAG_BENCH,
+    DIAG_CHANNEL_COUNT
+} diag_channel_t;
+
+void DiagInit                   (void);
+void DiagSetClock               (const clock_profile_t profile);
+uint32_t DiagSpace              (const diag_channel_t channel);
+void DiagWrite                  (const diag_channel_t channel,
+                                 const char * string);
+uint32_t DiagDeferred           (void);
+uint32_t DiagDropped            (void);
+
+#endif // DIAGRTNS_H
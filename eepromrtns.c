@@ -0,0 +1,86 @@
+// On-chip EEPROM; see 8.2.4 EEPROM and 8.2.4.1 Initialization and Configuration.
+//
+// A word is addressed by its block (EEBLOCK) and its offset in the block (EEOFFSET) and read or written through
+// EERDWR. A read returns at once; a write keeps EEDONE WORKING set while the word is programmed (and, now and
+// then, while the EEPROM copies and erases a sector internally), so EepromWrite() waits for it. Erased words
+// read 0xFFFFFFFF.
+
+#include "TM4C123GH6PM.h"
+
+#include "eepromrtns.h"
+
+// EEDONE
+#define EEDONE_WORKING          (1U << 0)
+#define EEDONE_NOPERM           (1U << 4)
+#define EEDONE_WRBUSY           (1U << 5)
+
+// EESUPP
+#define EESUPP_ERETRY           (1U << 2)
+#define EESUPP_PRETRY           (1U << 3)
+
+static uint32_t waitDone(void);
+
+// Returns 1 if the EEPROM can be used. See 8.2.4.1 steps 1 to 8.
+uint32_t EepromInit(void)
+{
+    volatile uint32_t delay;
+
+    // 1. and 2. Enable the clock and wait for PREEPROM (at least 6 cycles)
+    SYSCTL->RCGCEEPROM |= (1 << 0);
+    while ((SYSCTL->PREEPROM & (1 << 0)) == 0);
+
+    // 3. and 4. The EEPROM finishes any operation interrupted by the reset first
+    waitDone();
+    if (EEPROM->EESUPP & (EESUPP_ERETRY | EESUPP_PRETRY))
+        return 0;
+
+    // 5. to 8. Reset the module and check again
+    SYSCTL->SREEPROM |= (1 << 0);
+    for (delay = 0; delay < 6; delay++);
+    SYSCTL->SREEPROM &= ~(1U << 0);
+    while ((SYSCTL->PREEPROM & (1 << 0)) == 0);
+
+    waitDone();
+    return (EEPROM->EESUPP & (EESUPP_ERETRY | EESUPP_PRETRY)) == 0;
+}
+
+void EepromRead(const uint32_t block,
+                uint32_t * const words,
+                const uint32_t count)
+{
+    uint32_t i;
+
+    EEPROM->EEBLOCK = block;
+    for (i = 0; i < count; i++)
+    {
+        EEPROM->EEOFFSET = i;
+        words[i] = EEPROM->EERDWR;
+    }
+}
+
+// Returns 1 if every word was written
+uint32_t EepromWrite(const uint32_t block,
+                     const uint32_t * const words,
+                     const uint32_t count)
+{
+    uint32_t i;
+
+    EEPROM->EEBLOCK = block;
+    for (i = 0; i < count; i++)
+    {
+        EEPROM->EEOFFSET = i;
+        EEPROM->EERDWR = words[i];
+        if (!waitDone())
+            return 0;
+    }
+    return 1;
+}
+
+// Returns 0 if the last write failed
+static uint32_t waitDone(void)
+{
+    uint32_t done;
+
+    while ((done = EEPROM->EEDONE) & EEDONE_WORKING);
+    return (done & (EEDONE_NOPERM | EEDONE_WRBUSY)) == 0;
+}
@@ -0,0 +1,18 @@
+#ifndef EEPROMRTNS_H
+#define EEPROMRTNS_H
+
+#include "stdint.h"
+
+// On-chip EEPROM: 2KB as 32 blocks of 16 32 bit words
+#define EEPROM_BLOCKS           32
+#define EEPROM_BLOCK_WORDS      16
+
+uint32_t EepromInit             (void);
+void EepromRead                 (const uint32_t block,
+                                 uint32_t * const words,
+                                 const uint32_t count);
+uint32_t EepromWrite            (const uint32_t block,
+                                 const uint32_t * const words,
+                                 const uint32_t count);
+
+#endif // EEPROMRTNS_H
@@ -0,0 +1,89 @@
+// Fixed format renderers used instead of sprintf() so that the printf family is not linked in.
+// FmtTime() gives the same result as sprintf("%2d:%02d\r") for hh 0 to 59 and mm 0 to 59: two table lookups and
+// seven stores, no division.
+
+#include "fmtrtns.h"
+
+// "00" to "59", two characters per entry
+static const char TwoDigits[60 * 2 + 1] =
+    "00" "01" "02" "03" "04" "05" "06" "07" "08" "09"
+    "10" "11" "12" "13" "14" "15" "16" "17" "18" "19"
+    "20" "21" "22" "23" "24" "25" "26" "27" "28" "29"
+    "30" "31" "32" "33" "34" "35" "36" "37" "38" "39"
+    "40" "41" "42" "43" "44" "45" "46" "47" "48" "49"
+    "50" "51" "52" "53" "54" "55" "56" "57" "58" "59";
+
+// Render hh:mm into a FMT_TIME_SZ frame; hours are space padded. Values above 59 are clamped.
+void FmtTime(char * const frame,
+             const uint32_t hh,
+             const uint32_t mm)
+{
+    const char * const h = &TwoDigits[(hh < 60 ? hh : 59) * 2];
+    const char * const m = &TwoDigits[(mm < 60 ? mm : 59) * 2];
+
+    frame[0] = (hh < 10) ? ' ' : h[0];
+    frame[1] = h[1];
+    frame[2] = ':';
+    frame[3] = m[0];
+    frame[4] = m[1];
+    frame[5] = '\r';
+    frame[6] = '\0';
+}
+
+// Render mm:ss into a FMT_TIME_SZ frame. Minutes are zero padded, so " 5:00" is five hours and "05:00" five
+// minutes. Values above 59 are clamped.
+void FmtCountdown(char * const frame,
+                  const uint32_t mm,
+                  const uint32_t ss)
+{
+    FmtTime(frame, mm, ss);
+    frame[0] = TwoDigits[(mm < 60 ? mm : 59) * 2];
+}
+
+// Render value in decimal into a buffer of at least FMT_UNSIGNED_SZ characters. Returns the number of digits.
+uint32_t FmtUnsigned(char * const buffer,
+                     uint32_t value)
+{
+    char digits[FMT_UNSIGNED_SZ - 1];
+    uint32_t count = 0;
+    uint32_t i;
+
+    // Least significant digit first; the compiler turns the division by 10 into a multiply
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    for (i = 0; i < count; i++)
+        buffer[i] = digits[count - 1 - i];
+    buffer[count] = '\0';
+
+    return count;
+}
+
+// Append a space and value in decimal to the first length characters of a row with room for FMT_UNSIGNED_SZ
+// more. Returns the new length; the row is NUL terminated. Used for the columns of the diagnostic dumps.
+uint32_t FmtAppendUnsigned(char * const row,
+                           const uint32_t length,
+                           const uint32_t value)
+{
+    row[length] = ' ';
+    return length + 1 + FmtUnsigned(&row[length + 1], value);
+}
+
+// Render the low digits (1 to 8) nibbles of value in upper case hex, zero padded, into a buffer of at least
+// digits + 1 characters. Returns digits.
+uint32_t FmtHex(char * const buffer,
+                const uint32_t value,
+                const uint32_t digits)
+{
+    static const char Hex[16 + 1] = "0123456789ABCDEF";
+    uint32_t i;
+
+    for (i = 0; i < digits; i++)
+        buffer[i] = Hex[(value >> ((digits - 1 - i) * 4)) & 0xF];
+    buffer[digits] = '\0';
+
+    return digits;
+}
@@ -0,0 +1,30 @@
+#ifndef FMTRTNS_H
+#define FMTRTNS_H
+
+#include "stdint.h"
+
+// "hh:mm\r" plus the terminating NUL
+#define FMT_TIME_SZ             (6 + 1)
+
+// Longest decimal uint32_t (4294967295) plus the terminating NUL
+#define FMT_UNSIGNED_SZ         (10 + 1)
+
+// Eight hex digits plus the terminating NUL
+#define FMT_HEX_SZ              (8 + 1)
+
+void FmtTime                    (char * const frame,
+                                 const uint32_t hh,
+                                 const uint32_t mm);
+void FmtCountdown               (char * const frame,
+                                 const uint32_t mm,
+                                 const uint32_t ss);
+uint32_t FmtUnsigned            (char * const buffer,
+                                 uint32_t value);
+uint32_t FmtAppendUnsigned      (char * const row,
+                                 const uint32_t length,
+                                 const uint32_t value);
+uint32_t FmtHex                 (char * const buffer,
+                                 const uint32_t value,
+                                 const uint32_t digits);
+
+#endif // FMTRTNS_H
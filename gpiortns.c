@@ -46,8 +46,16 @@
 
 #include "gpiortns.h"
 
-void GpioEnable(const gpio_port_t port)
+void GpioEnable(const gpio_port_t port,
+                const gpio_aperture_t aperture)
 {
+    // Select the aperture; see page 258 (Register 9: GPIOHBCTL). The port's registers must then only be
+    // accessed through that aperture (GPIOx or GPIOx_AHB).
+    if (aperture == GPIO_AHB)
+        SYSCTL->GPIOHBCTL |= (1 << port);
+    else
+        SYSCTL->GPIOHBCTL &= ~(1U << port);
+
     if (SYSCTL->PRGPIO & (1 << port))
         return;
     // Disable clock gating for GPIO. See page 656 (Initialisation and Configuration step 1) and
@@ -11,6 +11,53 @@ typedef enum
     PORT_F
 } gpio_port_t;
 
-void GpioEnable                 (const gpio_port_t port);
+#define GPIO_PORT_COUNT         6
+
+// Bus aperture used to access a port's registers (see the notes in gpiortns.c)
+typedef enum
+{
+    GPIO_APB = 0,
+    GPIO_AHB
+} gpio_aperture_t;
+
+// Define GPIO_USE_AHB to access all ports through the AHB aperture. The GPIO_PORTx names resolve to the
+// matching register block at compile time, so pass GPIO_APERTURE to GpioEnable() and use GPIO_PORTx->...
+// everywhere else.
+#define GPIO_USE_AHB
+
+#ifdef GPIO_USE_AHB
+#define GPIO_APERTURE           GPIO_AHB
+#define GPIO_PORTA              GPIOA_AHB
+#define GPIO_PORTB              GPIOB_AHB
+#define GPIO_PORTC              GPIOC_AHB
+#define GPIO_PORTD              GPIOD_AHB
+#define GPIO_PORTE              GPIOE_AHB
+#define GPIO_PORTF              GPIOF_AHB
+#else
+#define GPIO_APERTURE           GPIO_APB
+#define GPIO_PORTA              GPIOA
+#define GPIO_PORTB              GPIOB
+#define GPIO_PORTC              GPIOC
+#define GPIO_PORTD              GPIOD
+#define GPIO_PORTE              GPIOE
+#define GPIO_PORTF              GPIOF
+#endif
+
+// GPIOLOCK value that unlocks GPIOCR; see page 684 (Register 19: GPIOLOCK). PC0-PC3, PD7 and PF0 are only
+// reconfigured once committed in GPIOCR.
+#define GPIO_LOCK_KEY           0x4C4F434B
+
+// Single store pin access through the GPIODATA address mask; see page 654 (Data Register Operation).
+// Address bits 9:2 select the bits a GPIODATA access affects, so DATA_BITS[1 << pin] reads or writes only
+// that pin: no read-modify-write, and safe against an interrupt handler changing other pins of the port.
+// With constant arguments each macro compiles to a single load or store.
+#define GPIO_PIN_MASK(pin)              (1U << (pin))
+#define GPIO_PIN_SET(port, pin)         ((port)->DATA_BITS[GPIO_PIN_MASK(pin)] = GPIO_PIN_MASK(pin))
+#define GPIO_PIN_CLEAR(port, pin)       ((port)->DATA_BITS[GPIO_PIN_MASK(pin)] = 0)
+#define GPIO_PIN_WRITE(port, pin, on)   ((port)->DATA_BITS[GPIO_PIN_MASK(pin)] = (on) ? GPIO_PIN_MASK(pin) : 0)
+#define GPIO_PIN_READ(port, pin)        ((port)->DATA_BITS[GPIO_PIN_MASK(pin)] != 0)
+
+void GpioEnable                 (const gpio_port_t port,
+                                 const gpio_aperture_t aperture);
 
 #endif // GPIORTNS_H
@@ -0,0 +1,510 @@
+// Interrupt level input handling, driven by Wide Timer 0 B: debounce and auto-repeat for the discrete switches
+// of the Switches[] table, on any pins of any ports, and (with KEYPAD defined) a key matrix scanned only while
+// a key is down.
+//
+// The first edge of a press masks the pin in GPIOIM, so the bounces that follow do not interrupt, and starts a
+// one shot timer for INPUT_DEBOUNCE_TIME. When it times out the pin is sampled again: if the switch still reads
+// pressed the press is queued with the time of its first edge; either way the edges latched in GPIORIS while
+// the pin was masked are cleared (GPIOICR) before the pin is unmasked. A bouncy switch interrupts once per press
+// instead of once per edge, and only validated presses take a queue slot.
+//
+// A validated switch is held: its pin is unmasked for the rising (release) edge (GPIOIEV), so the release and
+// its bounces are debounced the same way as a press. A switch with a repeat id queues it at INPUT_LONG_PRESS
+// and every INPUT_REPEAT_TIME after the first edge while it is held; the one shot is armed for the next repeat,
+// so holding a switch costs one timer interrupt per repeat and no GPIO interrupts.
+//
+// The keypad columns are driven low while idle, so any key pulls its row low and the row edge wakes us like a
+// switch press. The rows are then masked and the one shot scans the matrix every KEYPAD_SCAN_TIME, one column
+// low at a time; a key set that reads the same KEYPAD_STABLE_SCANS times is taken, and its new keys queued.
+// Once no key reads down the columns go back low, the latched row edges are cleared and, if the rows read
+// high, they are unmasked again: an idle keypad costs no timer interrupts and no cycles.
+//
+// InputInit() configures every pin of the tables, enables its port and the port's interrupt. The GPIO handler
+// of a port with inputs must call InputHandler() for it; GPIOF_Handler does for the switches.
+//
+// WTimer0B shares the 32 bit configuration, the PIOSC clock (GPTMCC ALTCLK) and the peripheral clock with
+// WTimer0A, so InputInit() must be called after TimerInit(). Each switch, and the keypad, has its own deadline;
+// the one shot is armed for the earliest.
+
+#include "TM4C123GH6PM.h"
+
+#include "benchrtns.h"
+#include "gpiortns.h"
+#include "inputrtns.h"
+#include "queuertns.h"
+#include "timerrtns.h"
+#include "uartrtns.h"
+
+#define INPUT_PRESCALE          (16000 - 1)     // PIOSC 16MHz / 16000 = 1ms; as for WTimer0A
+
+#define GPTM_INT_TBTO           (1U << 8)       // GPTMIMR/GPTMICR: timer B time-out interrupt
+#define GPTM_CTL_TBEN           (1U << 8)
+
+#define INPUT_NO_REPEAT         0
+
+#define KEYPAD_ROW_PINS         (((1U << KEYPAD_ROWS) - 1) << KEYPAD_ROW_FIRST_PIN)
+#define KEYPAD_COLUMN_PINS      (((1U << KEYPAD_COLUMNS) - 1) << KEYPAD_COLUMN_FIRST_PIN)
+
+// The keypad pins in inputrtns.h are shared with UARTs (Table 23-5): rows PC4-PC7 with UART4 and UART3, columns
+// PE0/PE1 with UART7
+#ifdef KEYPAD
+#if defined(UART3_BAUD) || defined(UART4_BAUD)
+#error "The keypad rows PC4-PC7 are the UART3 and UART4 pins"
+#endif
+#ifdef UART7_BAUD
+#error "The keypad columns PE0/PE1 are the UART7 pins"
+#endif
+#endif
+
+typedef enum
+{
+    INPUT_IDLE = 0,             // unmasked for the falling (press) edge
+    INPUT_SETTLING,             // masked until the deadline, then sampled
+    INPUT_HELD                  // unmasked for the rising (release) edge; repeats at the deadline
+} input_state_t;
+
+typedef struct
+{
+    uint8_t  port;              // gpio_port_t
+    uint8_t  pin;
+    uint8_t  id;                // queued when a press is validated
+    uint8_t  repeatId;          // queued while held, or INPUT_NO_REPEAT
+} input_switch_t;
+
+static const input_switch_t Switches[] =
+{
+    { SWITCH_1_PORT, SWITCH_1_PIN, SWITCH_1, INPUT_NO_REPEAT },
+    { SWITCH_2_PORT, SWITCH_2_PIN, SWITCH_2, SWITCH_2_REPEAT }
+};
+
+#define SWITCH_COUNT            (sizeof(Switches) / sizeof(Switches[0]))
+
+// GPIO interrupt numbers (see startup_TM4C123.s; look for GPIOA_Handler to GPIOF_Handler)
+static const uint8_t PortIrq[GPIO_PORT_COUNT] = { 0, 1, 2, 3, 4, 30 };
+
+static uint8_t PortPins[GPIO_PORT_COUNT];       // the switch pins of each port
+
+static input_state_t State[SWITCH_COUNT];
+static uint32_t FirstEdge[SWITCH_COUNT];        // TimerNow() at the edge that started the press or release
+static uint32_t Deadline[SWITCH_COUNT];         // sample or repeat time; unused while idle
+
+#ifdef KEYPAD
+static uint32_t Scanning;                       // rows masked; scanned at KeypadDeadline
+static uint32_t KeypadDeadline;
+static uint32_t KeypadRead;                     // the keys of the last scan, bit k for key k
+static uint32_t KeypadReads;                    // scans in a row that read KeypadRead
+static uint32_t KeypadKeys;                     // the keys taken as down
+#endif
+
+#ifdef BENCHMARK
+// Synthetic presses (see InputInject()): pins that read pressed whatever the pad says, and pins with a
+// synthetic edge waiting for InputHandler()
+static volatile uint32_t SimPressed[GPIO_PORT_COUNT];
+static volatile uint32_t SimEdges[GPIO_PORT_COUNT];
+#endif
+
+static GPIOA_Type * portRegs(const gpio_port_t port);
+static void setupInputs(const gpio_port_t port,
+                        const uint32_t pins);
+static void armDebounce(const uint32_t now);
+static uint32_t readLevel(const gpio_port_t port);
+#ifdef KEYPAD
+static void setupColumns(void);
+static void scanKeypad(const uint32_t now);
+#endif
+
+void InputInit(void)
+{
+    uint32_t port;
+    uint32_t i;
+
+    // One shot timer mode; see 11.4.1 steps 1 to 7. CFG and CC have been set up by TimerInit().
+    WTIMER0->CTL   &= ~GPTM_CTL_TBEN;               // disable timer B while we configure it
+    WTIMER0->TBMR  = 0x1;                           // one shot, count down
+    WTIMER0->TBPR  = INPUT_PRESCALE;
+    WTIMER0->ICR   = GPTM_INT_TBTO;
+    WTIMER0->IMR  |= GPTM_INT_TBTO;
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        State[i] = INPUT_IDLE;
+        PortPins[Switches[i].port] |= GPIO_PIN_MASK(Switches[i].pin);
+    }
+
+    for (port = 0; port < GPIO_PORT_COUNT; port++)
+    {
+        if (PortPins[port] != 0)
+            setupInputs((gpio_port_t)port, PortPins[port]);
+    }
+
+#ifdef KEYPAD
+    // The columns first, so that the rows do not see a key until they can wake us
+    setupColumns();
+    setupInputs(KEYPAD_ROW_PORT, KEYPAD_ROW_PINS);
+#endif
+
+    // Wide Timer 0B is interrupt number 95 (see startup_TM4C123.s; look for WTIMER0B_Handler)
+    // m = 95 / 32 = 2; hence we update ISER[2]; b = 95 % 32 = 31; hence we set bit 31.
+    // It must have the same priority as the GPIO handlers: they all change the GPIO interrupt registers and
+    // all queue events.
+    NVIC->IP[95] = 3 << 5;
+    NVIC->ISER[2] = (1U << 31);
+}
+
+// Called from the GPIO handler of a port with inputs. Every pending switch is serviced from one MIS read with
+// one ICR write: a press or a release edge masks the pin and starts its debounce. A keypad row edge starts the
+// scanning.
+void InputHandler(const gpio_port_t port)
+{
+    GPIOA_Type * const regs = portRegs(port);
+    uint32_t mis = regs->MIS;
+    uint32_t now = TimerNow();
+    uint32_t released = 0;
+    uint32_t i;
+
+#ifdef KEYPAD
+    if (port == KEYPAD_ROW_PORT && (mis & KEYPAD_ROW_PINS) != 0)
+    {
+        regs->IM &= ~KEYPAD_ROW_PINS;
+        regs->ICR = KEYPAD_ROW_PINS;
+        Scanning = 1;
+        KeypadReads = 0;
+        KeypadDeadline = now + KEYPAD_SCAN_TIME;
+    }
+#endif
+
+    mis &= PortPins[port];
+#ifdef BENCHMARK
+    // A synthetic edge only counts if the pin is unmasked for an edge in that direction, as for a real one
+    mis |= SimEdges[port] & regs->IM & (regs->IEV ^ SimPressed[port]);
+    SimEdges[port] = 0;
+#endif
+
+    regs->IM &= ~mis;
+    regs->ICR = mis;
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        uint32_t mask = GPIO_PIN_MASK(Switches[i].pin);
+
+        if (Switches[i].port != port || (mis & mask) == 0)
+            continue;
+
+        if (State[i] == INPUT_HELD)
+            released |= mask;
+        State[i]     = INPUT_SETTLING;
+        FirstEdge[i] = now;
+        Deadline[i]  = now + INPUT_DEBOUNCE_TIME;
+    }
+
+    // Back to detecting presses; the pins are masked so the change cannot raise an interrupt
+    regs->IEV &= ~released;
+
+    armDebounce(now);
+}
+
+// Called from WTIMER0B_Handler: sample the settling switches whose debounce time is up, queue the repeats that
+// are due and scan the keypad.
+void InputDebounceHandler(void)
+{
+    uint32_t now = TimerNow();
+    uint32_t settled[GPIO_PORT_COUNT] = { 0 };
+    uint32_t level[GPIO_PORT_COUNT];
+    uint32_t idle[GPIO_PORT_COUNT] = { 0 };
+    uint32_t held[GPIO_PORT_COUNT] = { 0 };
+    uint32_t port;
+    uint32_t i;
+
+    WTIMER0->ICR = GPTM_INT_TBTO;
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        if (State[i] == INPUT_SETTLING && (int32_t)(Deadline[i] - now) <= 0)
+            settled[Switches[i].port] |= GPIO_PIN_MASK(Switches[i].pin);
+    }
+
+    // Look for the release edge before sampling: a switch released after the IEV write latches GPIORIS and
+    // interrupts once unmasked, one released before it reads released below. The ICR forgets the bounces
+    // latched while masked.
+    for (port = 0; port < GPIO_PORT_COUNT; port++)
+    {
+        if (settled[port] == 0)
+            continue;
+
+        portRegs((gpio_port_t)port)->IEV |= settled[port];
+        portRegs((gpio_port_t)port)->ICR = settled[port];
+        level[port] = readLevel((gpio_port_t)port);
+    }
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        uint32_t mask = GPIO_PIN_MASK(Switches[i].pin);
+
+        port = Switches[i].port;
+
+        // The switches pull the pin low when pressed (see setupInputs())
+        if (settled[port] & mask)
+        {
+            if (level[port] & mask)
+            {
+                State[i] = INPUT_IDLE;
+                idle[port] |= mask;
+            }
+            else
+            {
+                QueuePut(Switches[i].id, FirstEdge[i]);
+#ifdef BENCHMARK
+                BenchPressed();
+#endif
+                State[i]    = INPUT_HELD;
+                Deadline[i] = FirstEdge[i] + INPUT_LONG_PRESS;
+                held[port] |= mask;
+            }
+        }
+        else if (State[i] == INPUT_HELD && Switches[i].repeatId != INPUT_NO_REPEAT &&
+                 (int32_t)(Deadline[i] - now) <= 0)
+        {
+            // Repeats are timed from the first edge, so a late interrupt does not stretch the interval
+            QueuePut(Switches[i].repeatId, Deadline[i]);
+            Deadline[i] += INPUT_REPEAT_TIME;
+            if ((int32_t)(Deadline[i] - now) <= 0)
+                Deadline[i] = now + INPUT_REPEAT_TIME;
+        }
+    }
+
+    for (port = 0; port < GPIO_PORT_COUNT; port++)
+    {
+        GPIOA_Type * regs;
+
+        if (settled[port] == 0)
+            continue;
+
+        regs = portRegs((gpio_port_t)port);
+        regs->IEV &= ~idle[port];
+        regs->ICR = idle[port];
+        regs->IM |= idle[port] | held[port];
+    }
+
+#ifdef KEYPAD
+    if (Scanning && (int32_t)(KeypadDeadline - now) <= 0)
+        scanKeypad(now);
+#endif
+
+    armDebounce(now);
+}
+
+#ifdef BENCHMARK
+// Press (pressed = 1) or release a switch without touching it: the pin reads as pressed and the port's GPIO
+// handler is triggered from software (NVIC STIR), so the press takes the same path through the debounce as a
+// real one.
+void InputInject(const uint32_t id,
+                 const uint32_t pressed)
+{
+    uint32_t i;
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        uint32_t port = Switches[i].port;
+        uint32_t mask = GPIO_PIN_MASK(Switches[i].pin);
+
+        if (Switches[i].id != id)
+            continue;
+
+        __disable_irq();
+        if (pressed)
+            SimPressed[port] |= mask;
+        else
+            SimPressed[port] &= ~mask;
+        SimEdges[port] |= mask;
+        __enable_irq();
+
+        NVIC->STIR = PortIrq[port];
+    }
+}
+#endif
+
+// The GPIO_PORTx names are not constants in every build (see gpiortns.h), so they are not kept in a table
+static GPIOA_Type * portRegs(const gpio_port_t port)
+{
+    switch (port)
+    {
+    case PORT_A:
+        return GPIO_PORTA;
+    case PORT_B:
+        return GPIO_PORTB;
+    case PORT_C:
+        return GPIO_PORTC;
+    case PORT_D:
+        return GPIO_PORTD;
+    case PORT_E:
+        return GPIO_PORTE;
+    default:
+        return GPIO_PORTF;
+    }
+}
+
+// Digital inputs with pull-ups, interrupting on the falling edge; see page 656 (Initialization and
+// Configuration). The port's interrupt is enabled at the priority of WTIMER0B_Handler.
+static void setupInputs(const gpio_port_t port,
+                        const uint32_t pins)
+{
+    GPIOA_Type * const regs = portRegs(port);
+    uint32_t irq = PortIrq[port];
+
+    GpioEnable(port, GPIO_APERTURE);
+
+    // PF0 (SW2) is locked, so commit the pins first; GPIOCR has no effect on the other pins
+    regs->LOCK = GPIO_LOCK_KEY;
+    regs->CR  |= pins;
+    regs->LOCK = 0;
+
+    regs->DIR &= ~pins;
+    regs->DEN |= pins;
+    regs->PUR |= pins;
+
+    regs->IS  &= ~pins;         // edge sensitive
+    regs->IBE &= ~pins;         // trigger is controlled by IEV
+    regs->IEV &= ~pins;         // falling edge trigger
+    regs->ICR  = pins;          // clear any prior interrupt
+    regs->IM  |= pins;
+
+    // m = irq / 32 selects ISER[m]; b = irq % 32 the bit
+    NVIC->IP[irq] = 3 << 5;
+    NVIC->ISER[irq / 32] = 1U << (irq % 32);
+}
+
+// Pin levels of the switches of a port; a switch reads 0 when pressed
+static uint32_t readLevel(const gpio_port_t port)
+{
+#ifdef BENCHMARK
+    return portRegs(port)->DATA_BITS[PortPins[port]] & ~SimPressed[port];
+#else
+    return portRegs(port)->DATA_BITS[PortPins[port]];
+#endif
+}
+
+#ifdef KEYPAD
+// Open drain outputs, driven low: a column not driven low floats, so it cannot fight a key of another column
+static void setupColumns(void)
+{
+    GPIOA_Type * const regs = portRegs(KEYPAD_COLUMN_PORT);
+
+    GpioEnable(KEYPAD_COLUMN_PORT, GPIO_APERTURE);
+
+    regs->LOCK = GPIO_LOCK_KEY;
+    regs->CR  |= KEYPAD_COLUMN_PINS;
+    regs->LOCK = 0;
+
+    regs->DATA_BITS[KEYPAD_COLUMN_PINS] = 0;
+    regs->ODR |= KEYPAD_COLUMN_PINS;
+    regs->DIR |= KEYPAD_COLUMN_PINS;
+    regs->DEN |= KEYPAD_COLUMN_PINS;
+}
+
+// One pass over the columns. A key set is taken once it has read the same KEYPAD_STABLE_SCANS times; its new
+// keys are queued. When no key is down the rows go back to waking us.
+static void scanKeypad(const uint32_t now)
+{
+    GPIOA_Type * const rows = portRegs(KEYPAD_ROW_PORT);
+    GPIOA_Type * const columns = portRegs(KEYPAD_COLUMN_PORT);
+    uint32_t keys = 0;
+    uint32_t column;
+    uint32_t added;
+    uint32_t key;
+
+    for (column = 0; column < KEYPAD_COLUMNS; column++)
+    {
+        uint32_t down;
+        uint32_t row;
+
+        columns->DATA_BITS[KEYPAD_COLUMN_PINS] = KEYPAD_COLUMN_PINS & ~(1U << (KEYPAD_COLUMN_FIRST_PIN + column));
+
+        // The first read gives the row pull-ups time to lift a row released by the last column
+        (void)rows->DATA_BITS[KEYPAD_ROW_PINS];
+        down = ~rows->DATA_BITS[KEYPAD_ROW_PINS] & KEYPAD_ROW_PINS;
+        down >>= KEYPAD_ROW_FIRST_PIN;
+
+        for (row = 0; down != 0; row++, down >>= 1)
+        {
+            if (down & 1)
+                keys |= 1U << (row * KEYPAD_COLUMNS + column);
+        }
+    }
+    columns->DATA_BITS[KEYPAD_COLUMN_PINS] = 0;
+
+    if (keys != KeypadRead)
+    {
+        KeypadRead = keys;
+        KeypadReads = 0;
+    }
+    if (KeypadReads < KEYPAD_STABLE_SCANS)
+        KeypadReads++;
+
+    if (KeypadReads == KEYPAD_STABLE_SCANS)
+    {
+        added = keys & ~KeypadKeys;
+        KeypadKeys = keys;
+        for (key = 0; added != 0; key++, added >>= 1)
+        {
+            if (added & 1)
+                QueuePut(KEYPAD_FIRST_ID + key, now);
+        }
+
+        // Clear the edges the scan itself latched; a key pressed after the ICR latches GPIORIS and interrupts
+        // once unmasked, one pressed before it reads low here and keeps us scanning
+        if (keys == 0)
+        {
+            rows->ICR = KEYPAD_ROW_PINS;
+            if (rows->DATA_BITS[KEYPAD_ROW_PINS] == KEYPAD_ROW_PINS)
+            {
+                Scanning = 0;
+                rows->IM |= KEYPAD_ROW_PINS;
+                return;
+            }
+        }
+    }
+
+    KeypadDeadline = now + KEYPAD_SCAN_TIME;
+}
+#endif
+
+// (Re)start the one shot for the earliest deadline: a switch settling, or held with a repeat id; the keypad
+// while it is scanned
+static void armDebounce(const uint32_t now)
+{
+    uint32_t wait = 0;
+    uint32_t i;
+
+    WTIMER0->CTL &= ~GPTM_CTL_TBEN;
+
+    for (i = 0; i < SWITCH_COUNT; i++)
+    {
+        int32_t remaining = (int32_t)(Deadline[i] - now);
+
+        if (State[i] == INPUT_IDLE ||
+            (State[i] == INPUT_HELD && Switches[i].repeatId == INPUT_NO_REPEAT))
+            continue;
+        if (remaining < 1)
+            remaining = 1;
+        if (wait == 0 || (uint32_t)remaining < wait)
+            wait = remaining;
+    }
+
+#ifdef KEYPAD
+    if (Scanning)
+    {
+        int32_t remaining = (int32_t)(KeypadDeadline - now);
+
+        if (remaining < 1)
+            remaining = 1;
+        if (wait == 0 || (uint32_t)remaining < wait)
+            wait = remaining;
+    }
+#endif
+
+    if (wait == 0)
+        return;
+
+    WTIMER0->TBILR = wait;
+    WTIMER0->CTL  |= GPTM_CTL_TBEN;
+}
@@ -0,0 +1,53 @@
+#ifndef INPUTRTNS_H
+#define INPUTRTNS_H
+
+#include "stdint.h"
+
+#include "gpiortns.h"
+
+// Discrete switches, one pin each, pressed low against the internal pull-up; configured from the Switches[]
+// table in inputrtns.c. The event ids are queued by the input handlers (see queuertns.h).
+#define SWITCH_1                1
+#define SWITCH_2                2
+#define SWITCH_2_REPEAT         3       // SW2 held down; queued every INPUT_REPEAT_TIME after INPUT_LONG_PRESS
+
+#define SWITCH_1_PORT           PORT_F
+#define SWITCH_1_PIN            4       // PF4
+#define SWITCH_2_PORT           PORT_F
+#define SWITCH_2_PIN            0       // PF0
+
+// A switch must still read pressed this long after its first edge to count as a press
+#define INPUT_DEBOUNCE_TIME     20      // milliseconds
+
+// Auto-repeat of a switch held down, timed from the first edge of the press
+#define INPUT_LONG_PRESS        600     // milliseconds to the first repeat
+#define INPUT_REPEAT_TIME       250     // milliseconds between repeats
+
+// Define KEYPAD for a key matrix: KEYPAD_ROWS consecutive row pins (inputs with pull-ups, interrupting on a
+// falling edge) and KEYPAD_COLUMNS consecutive column pins (open drain outputs, held low while idle). A key
+// press pulls its row low and wakes us; the columns are then scanned every KEYPAD_SCAN_TIME until the keys
+// are released. Key k (row * KEYPAD_COLUMNS + column) is queued as KEYPAD_FIRST_ID + k. The row port's GPIO
+// handler (KEYPAD_ROW_HANDLER) must call InputHandler(KEYPAD_ROW_PORT).
+// #define KEYPAD
+
+#define KEYPAD_ROWS             4
+#define KEYPAD_COLUMNS          4
+#define KEYPAD_KEYS             (KEYPAD_ROWS * KEYPAD_COLUMNS)
+#define KEYPAD_ROW_PORT         PORT_C
+#define KEYPAD_ROW_FIRST_PIN    4       // PC4-PC7
+#define KEYPAD_ROW_HANDLER      GPIOC_Handler
+#define KEYPAD_COLUMN_PORT      PORT_E
+#define KEYPAD_COLUMN_FIRST_PIN 0       // PE0-PE3
+#define KEYPAD_FIRST_ID         16
+#define KEYPAD_SCAN_TIME        10      // milliseconds between scans while a key is down
+#define KEYPAD_STABLE_SCANS     2       // equal scans for a press or a release to count
+
+void InputInit                  (void);
+void InputHandler               (const gpio_port_t port);
+void InputDebounceHandler       (void);
+
+// Benchmark builds only (see benchrtns.h)
+void InputInject                (const uint32_t id,
+                                 const uint32_t pressed);
+
+#endif // INPUTRTNS_H
@@ -0,0 +1,242 @@
+// RGB led patterns on PWM Module 1; see 20.4 Initialization and Configuration (PWM) and Table 23-5 (GPIO Pins
+// and Alternate Functions).
+//
+// The brightness of each colour is a PWM duty cycle, so the hardware keeps the led lit, dimmed or off without
+// the CPU. A pattern is a table of steps (three levels and a time); LedStep() moves to the next step and
+// returns the time until it is due, and main.c runs it from a software timer. A blink costs two calls a
+// period and a pulse one call a level, instead of a GPIO write and a timer per change of the led.
+//
+// A pattern cannot be left to the PWM generators alone: the PWM clock is the system clock divided by at most
+// 64, and with a 16 bit counter the slowest period at 80MHz is 52ms, too fast to see as a blink.
+//
+// PF1 red   M1PWM5  generator 2, output B
+// PF2 blue  M1PWM6  generator 3, output A
+// PF3 green M1PWM7  generator 3, output B
+//
+// The generators count down from LOAD: the output goes high at LOAD and low when the counter passes the
+// comparator, so the high time is LOAD - CMP. Comparator and LOAD writes take effect when the counter reaches
+// zero (CTL CMPxUPD and LOADUPD clear), i.e. at the end of a period, so a change never leaves a short pulse.
+// A level of 0 disables the output, which holds the pin low.
+
+#include "TM4C123GH6PM.h"
+
+#include "ledrtns.h"
+
+// RCC
+#define RCC_PWMDIV_M            (0x7U << 17)
+#define RCC_PWMDIV_64           (0x5U << 17)
+#define RCC_USEPWMDIV           (1U << 20)
+#define PWM_CLOCK_DIV           64
+
+// PWMnGENA/PWMnGENB actions
+#define GEN_ACTLOAD_HIGH        (0x3U << 2)
+#define GEN_ACTCMPAD_LOW        (0x2U << 6)
+#define GEN_ACTCMPBD_LOW        (0x2U << 10)
+
+// PWMnCTL
+#define CTL_ENABLE              (1U << 0)
+
+// PWMENABLE
+#define ENABLE_PWM5             (1U << 5)
+#define ENABLE_PWM6             (1U << 6)
+#define ENABLE_PWM7             (1U << 7)
+
+typedef struct
+{
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint16_t time;              // milliseconds
+} led_step_t;
+
+typedef struct
+{
+    const led_step_t * steps;
+    uint32_t count;
+    uint32_t repeats;           // 0: until stopped
+} led_table_t;
+
+// 4Hz, 60 times
+static const led_step_t AlarmSteps[] =
+{
+    {LED_LEVEL_MAX, 0, 0, 125},
+    {0,             0, 0, 125}
+};
+
+// Roughly quadratic ramp so that the brightness looks linear
+static const led_step_t SettingSteps[] =
+{
+    {0,   0, 0, 100},
+    {0,   4, 0, 100},
+    {0,  16, 0, 100},
+    {0,  36, 0, 100},
+    {0,  64, 0, 100},
+    {0, 100, 0, 100},
+    {0, 144, 0, 100},
+    {0, 196, 0, 100},
+    {0, 255, 0, 100},
+    {0, 196, 0, 100},
+    {0, 144, 0, 100},
+    {0, 100, 0, 100},
+    {0,  64, 0, 100},
+    {0,  36, 0, 100},
+    {0,  16, 0, 100},
+    {0,   4, 0, 100}
+};
+
+// Indexed by led_pattern_t
+static const led_table_t Patterns[] =
+{
+    {0,            0,                                          0},     // LED_OFF
+    {SettingSteps, sizeof(SettingSteps) / sizeof(led_step_t),  0},     // LED_SETTING
+    {AlarmSteps,   sizeof(AlarmSteps) / sizeof(led_step_t),    60}     // LED_ALARM
+};
+
+static led_pattern_t Current = LED_OFF;
+static uint32_t Step;
+static uint32_t Cycle;
+
+static uint32_t Load;
+
+// Last levels written, applied again when the PWM clock changes
+static uint8_t Red;
+static uint8_t Green;
+static uint8_t Blue;
+
+static uint32_t loadValue(const uint32_t clockHz);
+static uint32_t cmpValue(const uint8_t level);
+static void setLevels(const uint8_t red, const uint8_t green, const uint8_t blue);
+static uint32_t applyStep(void);
+
+void LedInit(const uint32_t clockHz)
+{
+    // 1. Clock PWM1. The pins (AFSEL, PCTL PMCn = 5 for M1PWMn) are set up in main.c.
+    SYSCTL->RCGCPWM |= (1 << 1);
+    while ((SYSCTL->PRPWM & (1 << 1)) == 0);
+
+    // 2. PWM clock = system clock / 64
+    SYSCTL->RCC = (SYSCTL->RCC & ~RCC_PWMDIV_M) | RCC_PWMDIV_64 | RCC_USEPWMDIV;
+
+    // 3. Count-down mode, immediate updates off (CTL = 0 while configuring)
+    PWM1->_2_CTL = 0;
+    PWM1->_3_CTL = 0;
+    PWM1->_2_GENB = GEN_ACTLOAD_HIGH | GEN_ACTCMPBD_LOW;
+    PWM1->_3_GENA = GEN_ACTLOAD_HIGH | GEN_ACTCMPAD_LOW;
+    PWM1->_3_GENB = GEN_ACTLOAD_HIGH | GEN_ACTCMPBD_LOW;
+
+    // 4. Period and duty cycles, all off
+    Load = loadValue(clockHz);
+    PWM1->_2_LOAD = Load;
+    PWM1->_3_LOAD = Load;
+    setLevels(0, 0, 0);
+
+    // 5. Start the generators; the outputs are enabled by setLevels()
+    PWM1->_2_CTL = CTL_ENABLE;
+    PWM1->_3_CTL = CTL_ENABLE;
+}
+
+// Called by ClockSetProfile(): the PWM clock follows the system clock
+void LedSetClock(const uint32_t clockHz)
+{
+    Load = loadValue(clockHz);
+    PWM1->_2_LOAD = Load;
+    PWM1->_3_LOAD = Load;
+    setLevels(Red, Green, Blue);
+}
+
+// Starts a pattern unless one of a higher priority is running. Returns the milliseconds until LedStep() is
+// due, 0 if the pattern was not started.
+uint32_t LedPattern(const led_pattern_t pattern)
+{
+    if (pattern == LED_OFF || pattern < Current)
+        return 0;
+
+    Current = pattern;
+    Step = 0;
+    Cycle = 0;
+    return applyStep();
+}
+
+// Switches the leds off if the pattern is running. Returns 1 if it was.
+uint32_t LedStop(const led_pattern_t pattern)
+{
+    if (pattern == LED_OFF || pattern != Current)
+        return 0;
+
+    Current = LED_OFF;
+    setLevels(0, 0, 0);
+    return 1;
+}
+
+// Moves to the next step. Returns the milliseconds until the following one, 0 once the pattern has finished.
+uint32_t LedStep(void)
+{
+    const led_table_t * table = &Patterns[Current];
+
+    if (Current == LED_OFF)
+        return 0;
+
+    if (++Step == table->count)
+    {
+        Step = 0;
+        if (table->repeats != 0 && ++Cycle == table->repeats)
+        {
+            LedStop(Current);
+            return 0;
+        }
+    }
+    return applyStep();
+}
+
+led_pattern_t LedCurrent(void)
+{
+    return Current;
+}
+
+static uint32_t loadValue(const uint32_t clockHz)
+{
+    return clockHz / PWM_CLOCK_DIV / LED_PWM_HZ - 1;
+}
+
+// High time LOAD - CMP = LOAD * level / LED_LEVEL_MAX. Returns LOAD (no high time) for a level that rounds
+// to 0.
+static uint32_t cmpValue(const uint8_t level)
+{
+    return Load - Load * level / LED_LEVEL_MAX;
+}
+
+static void setLevels(const uint8_t red, const uint8_t green, const uint8_t blue)
+{
+    uint32_t enable = 0;
+    uint32_t cmp;
+
+    Red = red;
+    Green = green;
+    Blue = blue;
+
+    if ((cmp = cmpValue(red)) < Load)
+    {
+        PWM1->_2_CMPB = cmp;
+        enable |= ENABLE_PWM5;
+    }
+    if ((cmp = cmpValue(blue)) < Load)
+    {
+        PWM1->_3_CMPA = cmp;
+        enable |= ENABLE_PWM6;
+    }
+    if ((cmp = cmpValue(green)) < Load)
+    {
+        PWM1->_3_CMPB = cmp;
+        enable |= ENABLE_PWM7;
+    }
+
+    PWM1->ENABLE = (PWM1->ENABLE & ~(ENABLE_PWM5 | ENABLE_PWM6 | ENABLE_PWM7)) | enable;
+}
+
+static uint32_t applyStep(void)
+{
+    const led_step_t * step = &Patterns[Current].steps[Step];
+
+    setLevels(step->red, step->green, step->blue);
+    return step->time;
+}
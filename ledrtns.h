@@ -0,0 +1,29 @@
+#ifndef LEDRTNS_H
+#define LEDRTNS_H
+
+#include "stdint.h"
+
+// RGB led patterns, in increasing priority: a pattern only replaces one of the same or a lower priority, or
+// one that has finished.
+typedef enum
+{
+    LED_OFF = 0,
+    LED_SETTING,                // gentle green pulse while an alarm is being set; runs until stopped
+    LED_ALARM                   // urgent red blink for 15 seconds when an alarm goes off
+} led_pattern_t;
+
+// Brightness of each colour, 0 (off) to LED_LEVEL_MAX
+#define LED_LEVEL_MAX           255
+
+// PWM frequency; the leds are driven by M1PWM5 (PF1 red), M1PWM6 (PF2 blue) and M1PWM7 (PF3 green)
+#define LED_PWM_HZ              1000
+
+void LedInit                    (const uint32_t clockHz);
+void LedSetClock                (const uint32_t clockHz);
+
+uint32_t LedPattern             (const led_pattern_t pattern);
+uint32_t LedStop                (const led_pattern_t pattern);
+uint32_t LedStep                (void);
+led_pattern_t LedCurrent        (void);
+
+#endif // LEDRTNS_H
@@ -1,533 +1,1398 @@
 // Kitchen oven timer implementation. UART0 is used as display.
+// Up to ALARM_COUNT alarms can run at the same time (see alarmrtns.h); one of them is selected for display.
 // State DISPLAY_CLOCK:
-// - Shows the current time (hard-coded)
-// - The clock is updated every minute
+// - Shows the current time, kept by the Hibernation module RTC (CURRENT_HH:CURRENT_MM after the first power up)
+// - The clock is updated every minute by the RTC match interrupt
 // - SW1 is used to change to DISPLAY_ALARM_INIT state
-// - SW2 is used to change to DISPLAY_ALARM state
+// - SW2 is used to start a new alarm and change to DISPLAY_ALARM state
 // State DISPLAY_ALARM_INIT:
 // - Shows alarm time as 0:00
-// - We can be in this state for 10 seconds only; after 10 seconds we go to DISPLAY_CLOCK state
+// - We can be in this state for 10 seconds only; after 10 seconds we go to DISPLAY_ALARM state if an alarm is
+//   running (showing the nearest one), otherwise to DISPLAY_CLOCK state
 // - SW1 remains in the same state (the ten second timer restarts)  
-// - SW2 is used to change to DISPLAY_ALARM state and increment the alarm time
+// - SW2 is used to start a new alarm, change to DISPLAY_ALARM state and increment the alarm time
 // State DISPLAY_ALARM:
-// - Shows the alarm time as a countdown
-// - SW1 is used to decrement the alarm time; if 0:00 we change to DISPLAY_ALARM_INIT state; SW2 is used to increment the alarm time;
-//   in both cases, the alarm timer restarts
-// - The alarm time is updated every minute
-// When the alarm goes off:
-// - The red led comes on
-// - We go back to DISPLAY_CLOCK state
-// - The alarm can be on for up to 10 seconds or until SW1 is pressed; in both cases the red led is switched off.
+// - Shows the selected alarm time as a countdown
+// - SW1 is used to decrement the alarm time; if 0:00 the alarm is cancelled and we change to DISPLAY_ALARM_INIT state;
+//   SW2 is used to increment the alarm time; in both cases, the alarm timer restarts
+// - Holding SW2 down increments the alarm time to the next multiple of 10 minutes on every auto-repeat
+// - The alarm time is updated every minute, and with COUNTDOWN_SECONDS defined every second (as mm:ss) once it
+//   is down to COUNTDOWN_SECONDS
+// With KEYPAD defined (see inputrtns.h) the minutes of a new alarm can be typed in and started with '#'; '*'
+// clears them, and A, B and C are the same as the 'n', 'a' and 'x' commands.
+// UART0 commands: 'n' is the same as SW1 from DISPLAY_CLOCK (start a new alarm), 'a' shows the next running
+// alarm, 'x' cancels the alarm shown. A host can also send framed binary commands (see protortns.h) to set the
+// clock, add, cancel and query alarms or upload a whole alarm schedule.
+// The transitions are the States table; each event is dispatched by a single lookup (see dispatch()).
+// When an alarm goes off:
+// - The red led blinks
+// - We show the next alarm due, or go back to DISPLAY_CLOCK state if there is none
+// - The alarm can blink for up to 15 seconds or until SW1 is pressed; in both cases the red led is switched off.
+// The green led pulses while in DISPLAY_ALARM_INIT. The led patterns are PWM duty cycles (see ledrtns.c).
 
-// Components used: Systick, UART0, PF0 (Switch 2), PF1 (Red led), PF4 (Switch 1)
+// The running alarms are checkpointed to the EEPROM and resumed after a reset, less the time the power was off,
+// as long as the RTC has kept counting (see statertns.c).
+// The boot banner and the dumps go to UART0 with the display, or with DIAG_ITM defined to the ITM stimulus
+// ports over SWO (see diagrtns.c).
+// With TRACE defined, the switch edges, timer interrupts, events, state changes and led steps are recorded in a
+// binary trace that survives a warm reset; 't' dumps it (see tracertns.c).
+// With MEMORY_REPORT defined, 'm' reports the deepest the stack has been and the fullest the event queue and the
+// UART0 ring buffers have been (see memrtns.c).
 
-// In system_TM4C123.c, CLOCK_SETUP = 0; we are using 16MHz clock
+// Components used: Wide Timer 0A, Wide Timer 0B, Hibernation module RTC, EEPROM, UART0, PWM1, PF0 (Switch 2),
+// PF1-PF3 (RGB led), PF4 (Switch 1); with KEYPAD, PC4-PC7 (keypad rows) and PE0-PE3 (keypad columns)
+// The switches are debounced, and the keypad scanned while a key is down, at interrupt level on Wide Timer 0B
+// (see inputrtns.c).
+// UART0 output is buffered and sent from UART0_Handler (optionally by uDMA); see uartrtns.h. Only the characters
+// of the time display that change are sent (see screenrtns.c).
+// The deadlines are software timers on Wide Timer 0A (see timerrtns.c).
+// The main loop is a cooperative scheduler (see schedrtns.c): the handlers post the tasks that consume what
+// they have produced and the highest priority ready task runs to completion. With TICKLESS defined the main
+// loop sleeps (WFI) while no task is ready, until the earliest timer expires or another interrupt arrives; there
+// is no periodic tick.
 
-#include "stdio.h"
-#include "stdlib.h"
+// In system_TM4C123.c, CLOCK_SETUP = 0; we are using 16MHz clock. With CLOCK_BURST defined we switch to the 80MHz
+// PLL profile while processing UART0 commands and back to 16MHz once UART0 has been quiet for CLOCK_QUIET_TIME
+// (see clockrtns.c).
 
 #include "TM4C123GH6PM.h"
+#include "alarmrtns.h"
+#include "benchrtns.h"
+#include "clockrtns.h"
+#include "diagrtns.h"
+#include "eepromrtns.h"
+#include "fmtrtns.h"
 #include "gpiortns.h"
+#include "inputrtns.h"
+#include "ledrtns.h"
+#include "memrtns.h"
+#include "periphrtns.h"
+#include "profrtns.h"
+#include "protortns.h"
+#include "queuertns.h"
+#include "rtcrtns.h"
+#include "schedrtns.h"
+#include "screenrtns.h"
+#include "statertns.h"
+#include "timerrtns.h"
+#include "tracertns.h"
 #include "uartrtns.h"
-#include "driverlib/sysctl.h"
 
-// Current time
+// Time of day set when the RTC has not kept the time (see rtcrtns.c)
 #define CURRENT_HH 12
 #define CURRENT_MM 12
 
-// Cater for switch bounce
-#define DEBOUNCE_TIME 200   // milliseconds
 
 // Delays
+#define DELAY_TIME_1  1000        // 1 second
 #define DELAY_TIME_10 10000       // 10 seconds
-#define DELAY_TIME_15 15000       // 15 seconds
 #define DELAY_TIME_60 60000       // 60 seconds
 
 // States
 #define DISPLAY_CLOCK       0
 #define DISPLAY_ALARM_INIT  1
 #define DISPLAY_ALARM       2
+#define STATE_COUNT         3
 
-static volatile int32_t CurrentTicks;
+// RGB led: PF1 red, PF2 blue, PF3 green (M1PWM5-7)
+#define LED_PINS            ((1 << 1) | (1 << 2) | (1 << 3))
 
-// Queue switch inputs
-#define MESSAGE_QUEUE_SZ 50
+// Tickless idle: sleep between timer expiries instead of polling
+#define TICKLESS
 
-typedef struct
+// Run at 80MHz while there are UART0 commands to process. Off by default: UartSetClock() disables UART0 for the
+// switch, so a character arriving just then is lost.
+// #define CLOCK_BURST
+
+// Stay at 80MHz this long after the last UART0 character, so a command or frame costs one PLL relock and not
+// one per character
+#define CLOCK_QUIET_TIME    100     // milliseconds
+
+// Define COUNTDOWN_SECONDS to show the selected alarm as mm:ss, updated every second, once it has this long left;
+// otherwise it counts down in minutes to the end. Whole minutes, at most 9, so that mm is one digit.
+// #define COUNTDOWN_SECONDS   (5 * DELAY_TIME_60)
+
+#ifdef COUNTDOWN_SECONDS
+#if COUNTDOWN_SECONDS <= 0 || COUNTDOWN_SECONDS > 9 * DELAY_TIME_60
+#error "COUNTDOWN_SECONDS must be 1 to 9 minutes"
+#endif
+#if COUNTDOWN_SECONDS % DELAY_TIME_60 != 0
+#error "COUNTDOWN_SECONDS must be whole minutes"
+#endif
+#endif
+
+// Boot diagnostic: once the first frame is on its way, print the system clock as decoded from RCC/RCC2
+// (ClockRead()) and the microseconds from main() to the first frame on the DIAG_BANNER channel, then redraw the
+// frame below them if that is UART0 (see diagrtns.h)
+// #define BANNER
+
+#ifdef BENCHMARK
+// The benchmark measures latencies in cycles of a fixed clock (see benchrtns.c)
+#undef CLOCK_BURST
+#endif
+
+// Tasks of the main loop, highest priority first (see schedrtns.h). Switch events come first, so a press waits
+// for at most one run of another task; the display follows every change.
+#define TASK_EVENTS         0   // queued switch, keypad and RTC events
+#define TASK_DISPLAY        1   // bring the frame and the alarm timers up to date
+#define TASK_TIMERS         2   // software timer callbacks
+#define TASK_COMMANDS       3   // UART0 commands and frames, a character per run
+#define TASK_REPORTS        4   // profiling, trace, memory and benchmark dumps
+#define TASK_COUNT          5
+
+// Software timers (see timerrtns.h)
+#define TIMER_ALARM         0   // nearest alarm expiry
+#define TIMER_ALARM_INIT    1   // DISPLAY_ALARM_INIT timeout
+#define TIMER_LED           2   // next step of the led pattern
+#define TIMER_DISPLAY       3   // minute boundary of the selected alarm's countdown
+#define TIMER_BENCH         4   // next synthetic press or release (BENCHMARK only)
+#define TIMER_SAVE          5   // next alarm checkpoint
+#define TIMER_CLOCK         6   // UART0 quiet period before dropping back to 16MHz (CLOCK_BURST only)
+#define TIMER_DIAG          7   // retry of a dump held back by a busy stimulus port (DIAG_ITM only)
+
+// With DIAG_ITM nothing interrupts when a stimulus port drains, so a dump held back is retried this often
+#define DIAG_RETRY_TIME     1       // milliseconds
+
+// Alarm changes are checkpointed to the EEPROM at most once a minute (see statertns.c)
+#define SAVE_INTERVAL       DELAY_TIME_60
+
+// Longest alarm that can be set: 23:59
+#define ALARM_MAX_MINUTES   (24 * 60 - 1)
+
+// Minutes added by each auto-repeat of SW2
+#define ALARM_REPEAT_STEP   10
+
+// Every module used, clocked together at start up (see periphrtns.c), including any UART built in with UARTn_BAUD
+// and the port of its pins (see uartrtns.h). They all stay clocked while the main loop sleeps because each of
+// them can wake it or is sending; deep-sleep is not used (SLEEPDEEP stays clear).
+static const periph_mask_t Peripherals =
 {
-    int32_t switchPressed;
-    int32_t switchPressedTime; // for debouncing
-} msgque_t;
+#ifdef KEYPAD
+    (1 << PORT_A) | (1 << PORT_C) | (1 << PORT_E) | (1 << PORT_F) | UART_PORT_MASK,  // as below; keypad
+#else
+    (1 << PORT_A) | (1 << PORT_F) | UART_PORT_MASK,     // UART0 pins; switches and leds; other UART pins
+#endif
+    (1 << UART_0) | UART_BUILT_MASK,
+    0,
+    (1 << 0),                       // Wide Timer 0: A software timers, B debounce
+    (1 << 0),                       // RTC
+#ifdef UART_TX_DMA
+    (1 << 0),
+#else
+    0,
+#endif
+    (1 << 1)                        // PWM1: leds
+};
 
-static msgque_t MessageQueue[MESSAGE_QUEUE_SZ];
-static volatile int32_t FrontQueue = -1;
-static volatile int32_t RearQueue = -1;
+// State shared between the main loop and the timer callbacks
+static uint32_t DisplayState = DISPLAY_CLOCK;
+static uint32_t ClockHH = CURRENT_HH;
+static uint32_t ClockMM = CURRENT_MM;
+static uint32_t Selected = ALARM_NONE;  // alarm shown in DISPLAY_ALARM and changed by SW1/SW2
+static uint32_t Entry;                  // minutes typed in on the keypad
 
-// Uart
-static volatile uint16_t UartActionReqd;
-static volatile char Uart0Char;
+// Checkpoints
+static uint32_t SavedChanges;           // AlarmChanges() at the last checkpoint
+static uint32_t LastSave;               // TimerNow() at the last checkpoint
 
 // Internal function prototypes
 static void setup_uart0(void);
 static void setup_leds(void);
-static void setup_switch1(void);
-static void setup_switch2(void);
-static void setup_systick(void);
-
-static void incrementTime(uint32_t * const hh,
-                          uint32_t * const mm);
-static void decrementTime(uint32_t * const hh,
-                          uint32_t * const mm);
+
+// Events of the state machine
+typedef enum
+{
+    EVENT_SW1 = 0,
+    EVENT_SW2,
+    EVENT_SW2_REPEAT,
+    EVENT_NEW,                  // 'n'
+    EVENT_NEXT,                 // 'a'
+    EVENT_CANCEL,               // 'x'
+    EVENT_INIT_TIMEOUT,         // ten seconds in DISPLAY_ALARM_INIT
+    EVENT_ALARMS_CHANGED,       // alarms have gone off, or a frame has changed them or the clock
+    EVENT_MINUTE,               // the clock has moved on a minute
+    EVENT_COUNTDOWN,            // the selected alarm's countdown has moved on a minute
+    EVENT_ENTER,                // '#' on the keypad
+    EVENT_COUNT
+} ui_event_t;
+
+// An action runs for an event in a state and returns the next state
+typedef uint32_t (*state_action_t)(void);
+
+typedef struct
+{
+    void (*entry)(void);
+    void (*exit)(void);
+    state_action_t actions[EVENT_COUNT];    // 0: the event is ignored in this state
+} ui_state_t;
+
+static void dispatch(const ui_event_t event);
+static void clockEntry(void);
+static void alarmInitEntry(void);
+static void alarmInitExit(void);
+static uint32_t stay(void);
+static uint32_t toAlarmInit(void);
+static uint32_t sw1Init(void);
+static uint32_t restartAlarmInit(void);
+static uint32_t sw1Alarm(void);
+static uint32_t sw2Start(void);
+static uint32_t sw2Alarm(void);
+static uint32_t sw2Repeat(void);
+static uint32_t selectNext(void);
+static uint32_t cancelSelected(void);
+static uint32_t initTimeout(void);
+static uint32_t alarmsChanged(void);
+static uint32_t selectNearest(void);
+static uint32_t enterAlarm(void);
+static uint32_t ledOff(void);
+static void ledShow(const led_pattern_t pattern);
+static uint32_t ledStop(const led_pattern_t pattern);
+
+// The state machine, indexed by DisplayState then by event; const, so it is kept in flash
+static const ui_state_t States[STATE_COUNT] =
+{
+    // DISPLAY_CLOCK
+    {
+        clockEntry, 0,
+        {
+            sw1Init,            // EVENT_SW1
+            sw2Start,           // EVENT_SW2
+            0,                  // EVENT_SW2_REPEAT
+            toAlarmInit,        // EVENT_NEW
+            selectNext,         // EVENT_NEXT
+            0,                  // EVENT_CANCEL
+            0,                  // EVENT_INIT_TIMEOUT
+            stay,               // EVENT_ALARMS_CHANGED
+            stay,               // EVENT_MINUTE
+            0,                  // EVENT_COUNTDOWN
+            enterAlarm          // EVENT_ENTER
+        }
+    },
+    // DISPLAY_ALARM_INIT
+    {
+        alarmInitEntry, alarmInitExit,
+        {
+            sw1Init,            // EVENT_SW1
+            sw2Start,           // EVENT_SW2
+            0,                  // EVENT_SW2_REPEAT
+            restartAlarmInit,   // EVENT_NEW
+            selectNext,         // EVENT_NEXT
+            0,                  // EVENT_CANCEL
+            initTimeout,        // EVENT_INIT_TIMEOUT
+            stay,               // EVENT_ALARMS_CHANGED
+            0,                  // EVENT_MINUTE
+            0,                  // EVENT_COUNTDOWN
+            enterAlarm          // EVENT_ENTER
+        }
+    },
+    // DISPLAY_ALARM
+    {
+        0, 0,
+        {
+            sw1Alarm,           // EVENT_SW1
+            sw2Alarm,           // EVENT_SW2
+            sw2Repeat,          // EVENT_SW2_REPEAT
+            toAlarmInit,        // EVENT_NEW
+            selectNext,         // EVENT_NEXT
+            cancelSelected,     // EVENT_CANCEL
+            0,                  // EVENT_INIT_TIMEOUT
+            alarmsChanged,      // EVENT_ALARMS_CHANGED
+            0,                  // EVENT_MINUTE
+            stay,               // EVENT_COUNTDOWN
+            enterAlarm          // EVENT_ENTER
+        }
+    }
+};
+
+static void eventTask(void);
+static void commandTask(void);
+static void reportTask(void);
+
+static void commandReceived(const char c);
+#ifdef KEYPAD
+static void keyPressed(const uint32_t key);
+#endif
+static void frameReceived(void);
+static uint32_t frameMinutes(const uint8_t * const field);
+static void showAlarms(void);
+
+static void clockMinute(void);
+static void alarmTimeout(const uint32_t id);
+static void alarmInitTimeout(const uint32_t id);
+static void ledTimeout(const uint32_t id);
+static void displayTimeout(const uint32_t id);
+static void saveTimeout(const uint32_t id);
+#ifdef BENCHMARK
+static void benchTimeout(const uint32_t id);
+#endif
+#ifdef CLOCK_BURST
+static void clockTimeout(const uint32_t id);
+#endif
+#ifdef DIAG_ITM
+static void diagTimeout(const uint32_t id);
+#endif
+
+static uint32_t alarmRemaining(const uint32_t alarm);
+static uint32_t alarmMinutes(const uint32_t alarm);
+static void setAlarmMinutes(const uint32_t alarm,
+                            const uint32_t minutes);
+static void scheduleAlarms(void);
+static void scheduleSave(void);
+static void resumeAlarms(void);
+
+static void idle(void);
+
+// The tasks, indexed by task number; const, so it is kept in flash
+static void (* const Tasks[TASK_COUNT])(void) =
+{
+    eventTask,                  // TASK_EVENTS
+    showAlarms,                 // TASK_DISPLAY
+    TimerService,               // TASK_TIMERS
+    commandTask,                // TASK_COMMANDS
+    reportTask                  // TASK_REPORTS
+};
+
 static void printTime(const uint32_t hh,
                       const uint32_t mm);
+#ifdef COUNTDOWN_SECONDS
+static void printCountdown(const uint32_t mm,
+                           const uint32_t ss);
+#endif
 
-static void printChar(const char c);
-static void printString(const char * string);
-static char readChar(void);
-
-static void enqueue(const int32_t input);
-static void dequeue(int32_t * const switchPressed,
-                    int32_t * const switchPressedTime);
+#if defined(PROFILE) || defined(TRACE) || defined(MEMORY_REPORT) || defined(BANNER)
+static void printDiag(const diag_channel_t channel,
+                      const char * string);
+#endif
+#ifdef BANNER
+static void printBanner(const uint32_t cycles);
+#endif
 
 // External function prototypes
-void SysTick_Handler(void);
+void WTIMER0A_Handler(void);
+void WTIMER0B_Handler(void);
 void GPIOF_Handler(void);
+#ifdef KEYPAD
+void KEYPAD_ROW_HANDLER(void);
+#endif
+void HIB_Handler(void);
 void UART0_Handler(void);
 
 int main(void)
 {
-    int32_t previousClockTicks;
-    int32_t previousAlarmTicks = 0;
-    int32_t previousSW1Ticks = 0;
-    int32_t ledOnTicks = 0;
+#ifdef BANNER
+    uint32_t bootStart;
+#endif
+
+#ifdef MEMORY_REPORT
+    // Before anything else has used the stack
+    MemInit();
+#endif
+    DiagInit();
+#ifdef BANNER
+    // Count cycles from here to the first frame
+    CoreDebug->DEMCR |= DEMCR_TRCENA;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA;
+    bootStart = DWT->CYCCNT;
+#endif
+
+    PeriphEnable(&Peripherals, &Peripherals, &Peripherals);
 
-    int32_t switchPressedTime;
-    
-    int32_t lastSwitch1Processed;
-    int32_t lastSwitch2Processed;
-    
     setup_uart0();
 
-    GpioEnable(PORT_F);
+    // Switch presses are debounced on Wide Timer 0B and timestamped with TimerNow(), so the timers must run
+    // before the switches are set up
+    TimerInit();
+    AlarmInit();
+#ifdef TRACE
+    TraceInit();
+#endif
+#ifdef PROFILE
+    ProfInit();
+#endif
+
+    GpioEnable(PORT_F, GPIO_APERTURE);
     setup_leds();
-    setup_switch1();
-    setup_switch2();
+    LedInit(ClockHz());
+    InputInit();
     
-//    To call SysCtlClockGet():
-//    - Change driverlib/sysctl.h to include <inc/hw_types.h>
-//    - Change the calling program to include "driverlib/sysctl.h"
-//    - Add driverlib-cm4f.lib to the project (to prevent linker error due to missing SysCtlClockGet())
-//    volatile uint32_t clock_speed = SysCtlClockGet();
-    char clockString[20 + 1];
-    sprintf(clockString, "\n\r%lu\n\r", SysCtlClockGet());
-    printString(clockString);
-   
-    uint32_t displayState = DISPLAY_CLOCK;
-    uint32_t clockHH = CURRENT_HH;
-    uint32_t clockMM = CURRENT_MM;
-    
-    printTime(clockHH, clockMM);
+    uint32_t checkpoint;
 
-    uint32_t alarmHH = 0;
-    uint32_t alarmMM = 0;
-    
-    // This must be the last step (unless some prior code requires CurrentTicks). 
-    setup_systick();
-    
-    previousClockTicks = CurrentTicks;
-    lastSwitch1Processed = lastSwitch2Processed = CurrentTicks;
+    // Nothing has been sent yet, so the first frame is sent in full
+    ScreenInit();
+
+    // The alarms of the last checkpoint can only be resumed if the RTC has kept counting through the reset
+    LastSave = TimerNow() - SAVE_INTERVAL;
+    checkpoint = StateInit();
+    if (!RtcInit())
+        RtcSet(CURRENT_HH * 3600 + CURRENT_MM * 60);
+    else if (checkpoint)
+        resumeAlarms();
+    clockMinute();
+    if (AlarmCount() != 0)
+        dispatch(EVENT_NEXT);
+#ifdef BANNER
+    // The first frame now rather than from TASK_DISPLAY, so that the banner follows it
+    showAlarms();
+    printBanner(DWT->CYCCNT - bootStart);
+#endif
+
+#ifdef BENCHMARK
+    BenchInit();
+    TimerStart(TIMER_BENCH, BENCH_INTERVAL, benchTimeout);
+#endif
     
     while (1)
     {
-        // Buffer inputs; we want to use the same value throughout the loop.
-        int32_t now = CurrentTicks;
-        int32_t switchPressed;
-        dequeue(&switchPressed, &switchPressedTime);
-        
-        // Cater for switch bounce
-        if (switchPressed == 1)
+        uint32_t task = SchedNext();
+        PROF_START(taskStart);
+
+        if (task == SCHED_NONE)
         {
-            if (abs(switchPressedTime - lastSwitch1Processed) < DEBOUNCE_TIME)
-            {
-                switchPressed = -1;
-            }
-            else
-            {
-                lastSwitch1Processed = switchPressedTime;
-            }
+            idle();
+            continue;
         }
-        else if (switchPressed == 2)
+
+        Tasks[task]();
+        PROF_STOP(PROF_TASK, taskStart);
+    }
+
+    // Commented to prevent compiler warning
+    // return(0);
+}
+
+// Route an event through the States table: one indexed lookup, then the exit and entry actions if the state
+// changes. Every event that is handled posts TASK_DISPLAY, so the display (and the alarm timers) are brought up
+// to date once the events pending have been handled.
+static void dispatch(const ui_event_t event)
+{
+    const state_action_t action = States[DisplayState].actions[event];
+    uint32_t next;
+
+    TRACE_RECORD(TRACE_EVENT, event);
+    if (action == 0)
+        return;
+
+    next = action();
+    if (next != DisplayState)
+    {
+        TRACE_RECORD(TRACE_STATE, next);
+        if (States[DisplayState].exit)
+            States[DisplayState].exit();
+        DisplayState = next;
+        if (States[next].entry)
+            States[next].entry();
+    }
+
+    SchedPost(TASK_DISPLAY);
+}
+
+// TASK_EVENTS: every queued event, oldest first
+static void eventTask(void)
+{
+    event_t event;
+
+    while (1)
+    {
+        PROF_START(queueStart);
+        uint32_t queued = QueueGet(&event);
+        PROF_STOP(PROF_QUEUE_GET, queueStart);
+
+        if (!queued)
+            return;
+
+        {
+            PROF_START(switchStart);
+
+            // Only debounced presses are queued (see inputrtns.c)
+            if (event.id == SWITCH_2)
+                dispatch(EVENT_SW2);
+            else if (event.id == SWITCH_2_REPEAT)
+                dispatch(EVENT_SW2_REPEAT);
+            else if (event.id == SWITCH_1)
+                dispatch(EVENT_SW1);
+            else if (event.id == RTC_MINUTE)
+                clockMinute();
+#ifdef KEYPAD
+            else if (event.id >= KEYPAD_FIRST_ID && event.id < KEYPAD_FIRST_ID + KEYPAD_KEYS)
+                keyPressed(event.id - KEYPAD_FIRST_ID);
+#endif
+
+            PROF_STOP(PROF_SWITCH, switchStart);
+        }
+    }
+}
+
+// TASK_COMMANDS: the next UART0 character, then again while there are more, so that an event waits for at most
+// one character (and the command or frame it completes)
+static void commandTask(void)
+{
+    char c;
+    PROF_START(commandStart);
+
+#ifdef CLOCK_BURST
+    ClockSetProfile(CLOCK_80MHZ);
+    TimerStart(TIMER_CLOCK, CLOCK_QUIET_TIME, clockTimeout);
+#endif
+    if (UartRxRead(UART_0, &c))
+    {
+        proto_result_t result = ProtoFeed(c);
+
+        if (result == PROTO_FRAME)
+            frameReceived();
+        else if (result == PROTO_NONE)
+            commandReceived(c);
+    }
+    if (UartRxAvailable(UART_0))
+        SchedPost(TASK_COMMANDS);
+    PROF_STOP(PROF_COMMAND, commandStart);
+}
+
+// TASK_REPORTS: a dump is sent as the transmit ring drains, so UART0_Handler posts this task on every interrupt;
+// with DIAG_ITM, TIMER_DIAG posts it again while a stimulus port is holding a dump back (see diagrtns.c)
+static void reportTask(void)
+{
+    uint32_t sent = 0;
+
+#ifdef PROFILE
+    sent |= ProfService();
+#endif
+#ifdef TRACE
+    sent |= TraceService();
+#endif
+#ifdef MEMORY_REPORT
+    sent |= MemService();
+#endif
+#ifdef BENCHMARK
+    sent |= BenchService();
+#endif
+
+#ifndef DIAG_ITM
+    // A dump on UART0 has moved the terminal cursor
+    if (sent)
+        ScreenInvalidate();
+#else
+    (void)sent;
+    if (DiagDeferred())
+        TimerStart(TIMER_DIAG, DIAG_RETRY_TIME, diagTimeout);
+#endif
+}
+
+// No task is ready. With TICKLESS, sleep until an interrupt posts a task or the earliest timer is due; without
+// it, poll the timers.
+// Interrupts are disabled while we decide to sleep so that a task posted by a handler cannot slip in between
+// the check and the WFI; WFI still wakes on a pending interrupt with PRIMASK set.
+static void idle(void)
+{
+#ifdef TICKLESS
+    __disable_irq();
+
+    if (SchedReady() == 0)
+    {
+        if (TimerArm())
+            __WFI();
+        else
+            SchedPost(TASK_TIMERS);     // a timer is already due
+    }
+
+    __enable_irq();
+#else
+    SchedPost(TASK_TIMERS);
+#endif
+}
+
+static void clockEntry(void)
+{
+    Selected = ALARM_NONE;
+}
+
+// Shows 0:00 for 10 seconds; SW2 starts a new alarm
+static void alarmInitEntry(void)
+{
+    Selected = ALARM_NONE;
+    TimerStart(TIMER_ALARM_INIT, DELAY_TIME_10, alarmInitTimeout);
+    ledShow(LED_SETTING);
+}
+
+static void alarmInitExit(void)
+{
+    TimerCancel(TIMER_ALARM_INIT);
+    ledStop(LED_SETTING);
+}
+
+// Any state: update the display only
+static uint32_t stay(void)
+{
+    return DisplayState;
+}
+
+// 'n' outside DISPLAY_ALARM_INIT
+static uint32_t toAlarmInit(void)
+{
+    return DISPLAY_ALARM_INIT;
+}
+
+// SW1 from DISPLAY_CLOCK or DISPLAY_ALARM_INIT switches the red led off, otherwise goes to (or restarts the ten
+// seconds of) DISPLAY_ALARM_INIT
+static uint32_t sw1Init(void)
+{
+    if (ledOff())
+        return DisplayState;
+
+    if (DisplayState == DISPLAY_ALARM_INIT)
+        return restartAlarmInit();
+    return DISPLAY_ALARM_INIT;
+}
+
+// 'n' in DISPLAY_ALARM_INIT
+static uint32_t restartAlarmInit(void)
+{
+    TimerStart(TIMER_ALARM_INIT, DELAY_TIME_10, alarmInitTimeout);
+    return DISPLAY_ALARM_INIT;
+}
+
+// SW1 in DISPLAY_ALARM switches the red led off or decrements the selected alarm. Decrementing to 0:00 cancels
+// the alarm and goes to DISPLAY_ALARM_INIT.
+static uint32_t sw1Alarm(void)
+{
+    uint32_t minutes;
+
+    if (ledOff())
+        return DISPLAY_ALARM;
+    if (!AlarmActive(Selected))
+        return DISPLAY_ALARM_INIT;
+
+    minutes = alarmMinutes(Selected);
+    if (minutes <= 1)
+    {
+        AlarmCancel(Selected);
+        return DISPLAY_ALARM_INIT;
+    }
+
+    setAlarmMinutes(Selected, minutes - 1);
+    return DISPLAY_ALARM;
+}
+
+// SW2 outside DISPLAY_ALARM starts a new one minute alarm, unless all alarms are in use
+static uint32_t sw2Start(void)
+{
+    uint32_t alarm;
+
+    ledOff();
+
+    alarm = AlarmAdd(TimerNow());
+    if (alarm == ALARM_NONE)
+        return DisplayState;
+
+    Selected = alarm;
+    setAlarmMinutes(Selected, 1);
+    return DISPLAY_ALARM;
+}
+
+// SW2 in DISPLAY_ALARM increments the selected alarm
+static uint32_t sw2Alarm(void)
+{
+    uint32_t minutes;
+
+    if (!AlarmActive(Selected))
+        return sw2Start();
+
+    ledOff();
+
+    minutes = alarmMinutes(Selected);
+    if (minutes < ALARM_MAX_MINUTES)
+        minutes++;
+    setAlarmMinutes(Selected, minutes);
+    return DISPLAY_ALARM;
+}
+
+// SW2 held down: step the selected alarm up to the next multiple of ALARM_REPEAT_STEP minutes. The press that
+// started the hold has already selected an alarm and changed to DISPLAY_ALARM.
+static uint32_t sw2Repeat(void)
+{
+    uint32_t minutes;
+
+    if (!AlarmActive(Selected))
+        return DISPLAY_ALARM;
+
+    minutes = (alarmMinutes(Selected) / ALARM_REPEAT_STEP + 1) * ALARM_REPEAT_STEP;
+    if (minutes > ALARM_MAX_MINUTES)
+        minutes = ALARM_MAX_MINUTES;
+    setAlarmMinutes(Selected, minutes);
+    return DISPLAY_ALARM;
+}
+
+// 'a': show the next running alarm after the selected one
+static uint32_t selectNext(void)
+{
+    uint32_t i;
+
+    for (i = 1; i <= ALARM_COUNT; i++)
+    {
+        uint32_t alarm = (Selected == ALARM_NONE ? i - 1 : Selected + i) % ALARM_COUNT;
+        if (AlarmActive(alarm))
+        {
+            Selected = alarm;
+            return DISPLAY_ALARM;
+        }
+    }
+    return DisplayState;
+}
+
+// 'x': cancel the alarm shown
+static uint32_t cancelSelected(void)
+{
+    if (AlarmActive(Selected))
+        AlarmCancel(Selected);
+    return selectNearest();
+}
+
+// DISPLAY_ALARM_INIT has timed out
+static uint32_t initTimeout(void)
+{
+    return selectNearest();
+}
+
+// In DISPLAY_ALARM, alarms have gone off or have been changed: keep showing the selected alarm if it is still
+// running
+static uint32_t alarmsChanged(void)
+{
+    if (AlarmActive(Selected))
+        return DISPLAY_ALARM;
+    return selectNearest();
+}
+
+// Show the next alarm due, or go back to the clock
+static uint32_t selectNearest(void)
+{
+    Selected = AlarmNearest();
+    return (Selected == ALARM_NONE) ? DISPLAY_CLOCK : DISPLAY_ALARM;
+}
+
+// '#' on the keypad: start a new alarm for the minutes typed in, unless there are none or all alarms are in use
+static uint32_t enterAlarm(void)
+{
+    uint32_t minutes = Entry;
+    uint32_t alarm;
+
+    Entry = 0;
+    if (minutes == 0)
+        return DisplayState;
+
+    ledOff();
+
+    alarm = AlarmAdd(TimerNow());
+    if (alarm == ALARM_NONE)
+        return DisplayState;
+
+    Selected = alarm;
+    setAlarmMinutes(Selected, minutes);
+    return DISPLAY_ALARM;
+}
+
+// Returns 1 if the red led was blinking
+static uint32_t ledOff(void)
+{
+    return ledStop(LED_ALARM);
+}
+
+// Starts a led pattern unless a more urgent one is running (see ledrtns.h)
+static void ledShow(const led_pattern_t pattern)
+{
+    uint32_t time = LedPattern(pattern);
+
+    if (time != 0)
+        TimerStart(TIMER_LED, time, ledTimeout);
+}
+
+// Returns 1 if the pattern was running
+static uint32_t ledStop(const led_pattern_t pattern)
+{
+    if (!LedStop(pattern))
+        return 0;
+
+    TimerCancel(TIMER_LED);
+    return 1;
+}
+
+// Single character commands on UART0:
+// n - start a new alarm (as SW1 from DISPLAY_CLOCK; SW2 then sets it)
+// a - show the next running alarm
+// x - cancel the alarm being shown
+// p - dump the profiling table (with PROFILE defined; see profrtns.h)
+// z - clear the profiling table
+// t - dump the event trace (with TRACE defined; see tracertns.h)
+// m - dump the stack, queue and UART0 high-water marks (with MEMORY_REPORT defined; see memrtns.h)
+static void commandReceived(const char c)
+{
+    switch (c)
+    {
+    case 'n':
+        dispatch(EVENT_NEW);
+        break;
+
+    case 'a':
+        dispatch(EVENT_NEXT);
+        break;
+
+    case 'x':
+        dispatch(EVENT_CANCEL);
+        break;
+
+#ifdef PROFILE
+    case 'p':
+        printDiag(DIAG_PROFILE, "\n\r");
+        ProfDump();
+        SchedPost(TASK_REPORTS);
+        break;
+
+    case 'z':
+        ProfReset();
+        break;
+#endif
+
+#ifdef TRACE
+    case 't':
+        printDiag(DIAG_TRACE, "\n\r");
+        TraceDump();
+        SchedPost(TASK_REPORTS);
+        break;
+#endif
+
+#ifdef MEMORY_REPORT
+    case 'm':
+        printDiag(DIAG_MEMORY, "\n\r");
+        MemDump();
+        SchedPost(TASK_REPORTS);
+        break;
+#endif
+
+    default:
+        break;
+    }
+}
+
+#ifdef KEYPAD
+// A keypad key, numbered as in inputrtns.h: the digits type in the minutes of a new alarm (at most
+// ALARM_MAX_MINUTES), '#' starts it and '*' clears the minutes typed; A, B and C are UART0 commands
+static void keyPressed(const uint32_t key)
+{
+    static const char Legend[KEYPAD_KEYS + 1] = "123A456B789C*0#D";
+    char c = Legend[key];
+
+    if (c >= '0' && c <= '9')
+    {
+        Entry = Entry * 10 + (c - '0');
+        if (Entry > ALARM_MAX_MINUTES)
+            Entry = ALARM_MAX_MINUTES;
+    }
+    else if (c == '#')
+        dispatch(EVENT_ENTER);
+    else if (c == '*')
+        Entry = 0;
+    else if (c == 'A')
+        commandReceived('n');
+    else if (c == 'B')
+        commandReceived('a');
+    else if (c == 'C')
+        commandReceived('x');
+}
+#endif
+
+// Apply a framed command (see protortns.h) and answer it. A schedule is checked completely before any alarm
+// is changed, so it is applied all or nothing, and the display is updated once for the whole frame.
+static void frameReceived(void)
+{
+    uint8_t reply[PROTO_PAYLOAD_SZ];
+    uint32_t replyLength = 1;
+    uint32_t command = ProtoCommand();
+    uint32_t length;
+    const uint8_t * payload = ProtoPayload(&length);
+    proto_status_t status = PROTO_OK;
+    uint32_t minutes;
+    uint32_t alarm;
+    uint32_t i;
+
+    switch (command)
+    {
+    case PROTO_SET_CLOCK:
+        if (length != 2)
+            status = PROTO_ERR_LENGTH;
+        else if (payload[0] > 23 || payload[1] > 59)
+            status = PROTO_ERR_RANGE;
+        else
         {
-            if (abs(switchPressedTime - lastSwitch2Processed) < DEBOUNCE_TIME)
-            {
-                switchPressed = -1;
-            }
-            else
-            {
-                lastSwitch2Processed = switchPressedTime;
-            }
+            RtcSet(payload[0] * 3600 + payload[1] * 60);
+            ClockHH = payload[0];
+            ClockMM = payload[1];
+            // The checkpoint's expiry times are RTC counts, so it is stale from now: rewrite it at once
+            TimerStart(TIMER_SAVE, 0, saveTimeout);
         }
+        break;
 
-        if (switchPressed == 2)
+    case PROTO_ADD_ALARM:
+        if (length != 2)
         {
-            GPIOF->DATA &= ~(1U << 1);       // Turn red led off
+            status = PROTO_ERR_LENGTH;
+            break;
+        }
+        minutes = frameMinutes(payload);
+        if (minutes == 0 || minutes > ALARM_MAX_MINUTES)
+        {
+            status = PROTO_ERR_RANGE;
+            break;
+        }
+        alarm = AlarmAdd(TimerNow());
+        if (alarm == ALARM_NONE)
+        {
+            status = PROTO_ERR_FULL;
+            break;
+        }
+        setAlarmMinutes(alarm, minutes);
+        reply[replyLength++] = (uint8_t)alarm;
+        break;
 
-            displayState = DISPLAY_ALARM;
-            incrementTime(&alarmHH, &alarmMM);
-            printTime(alarmHH, alarmMM);
+    case PROTO_CANCEL_ALARM:
+        if (length != 1)
+            status = PROTO_ERR_LENGTH;
+        else if (payload[0] >= ALARM_COUNT || !AlarmActive(payload[0]))
+            status = PROTO_ERR_RANGE;
+        else
+            AlarmCancel(payload[0]);
+        break;
 
-            previousAlarmTicks = now;
+    case PROTO_QUERY:
+        if (length != 0)
+        {
+            status = PROTO_ERR_LENGTH;
+            break;
+        }
+        reply[replyLength++] = (uint8_t)ClockHH;
+        reply[replyLength++] = (uint8_t)ClockMM;
+        reply[replyLength++] = (uint8_t)DisplayState;
+        reply[replyLength++] = (uint8_t)Selected;
+        reply[replyLength++] = (uint8_t)AlarmCount();
+        for (alarm = 0; alarm < ALARM_COUNT; alarm++)
+        {
+            if (!AlarmActive(alarm))
+                continue;
+            minutes = alarmMinutes(alarm);
+            reply[replyLength++] = (uint8_t)alarm;
+            reply[replyLength++] = (uint8_t)(minutes & 0xFF);
+            reply[replyLength++] = (uint8_t)(minutes >> 8);
         }
-        else if (switchPressed == 1)
+        break;
+
+    case PROTO_SCHEDULE:
+        if (length == 0 || length != 1 + 2 * (uint32_t)payload[0])
         {
-            if (GPIOF->DATA & (1 << 1))
-            {
-                GPIOF->DATA &= ~(1U << 1);       // Turn red led off
-            }
-            else
-            {
-                if (alarmHH == 0 && alarmMM == 0)
-                {
-                    displayState = DISPLAY_ALARM_INIT;
-                    previousSW1Ticks = now;
-                }
-                else if (displayState == DISPLAY_ALARM)
-                {
-                    decrementTime(&alarmHH, &alarmMM);
-                    
-                    if (alarmHH == 0 && alarmMM == 0)
-                    {
-                        displayState = DISPLAY_ALARM_INIT;
-                        previousSW1Ticks = now;
-                    }
-                    else
-                    {
-                        previousAlarmTicks = now;
-                    }
-                }
-                
-                printTime(alarmHH, alarmMM);
-            }
+            status = PROTO_ERR_LENGTH;
+            break;
         }
-        else // nothing in MessageQueue
+        if (payload[0] > ALARM_COUNT)
         {
-            if (displayState == DISPLAY_ALARM_INIT && abs(now - previousSW1Ticks) >= DELAY_TIME_10)
-            {
-                displayState = DISPLAY_CLOCK;
-                printTime(clockHH, clockMM);
-            }
-
-            if (displayState == DISPLAY_ALARM && abs(now - previousAlarmTicks) >= DELAY_TIME_60)
-            {
-                decrementTime(&alarmHH, &alarmMM);
-                if (alarmHH == 0 && alarmMM == 0)
-                {
-                    displayState = DISPLAY_CLOCK;
-                    GPIOF->DATA |= (1 << 1);        // Turn red led on
-
-                    ledOnTicks = now;
-                    printTime(clockHH, clockMM);
-                }
-                else
-                {
-                    previousAlarmTicks = now;
-                    printTime(alarmHH, alarmMM);
-                }
-            }
-
-            if (GPIOF->DATA & (1 << 1))
-            {
-                if (abs(now - ledOnTicks) >= DELAY_TIME_15)
-                {
-                    GPIOF->DATA &= ~(1U << 1);       // Turn red led off
-                }
-            }
+            status = PROTO_ERR_FULL;
+            break;
         }
+        for (i = 0; i < payload[0]; i++)
+        {
+            minutes = frameMinutes(&payload[1 + 2 * i]);
+            if (minutes == 0 || minutes > ALARM_MAX_MINUTES)
+                status = PROTO_ERR_RANGE;
+        }
+        if (status != PROTO_OK)
+            break;
 
-        if (abs(now - previousClockTicks) >= DELAY_TIME_60)
+        for (alarm = 0; alarm < ALARM_COUNT; alarm++)
         {
-            previousClockTicks = now;
-            incrementTime(&clockHH, &clockMM);
+            if (AlarmActive(alarm))
+                AlarmCancel(alarm);
+        }
+        for (i = 0; i < payload[0]; i++)
+            setAlarmMinutes(AlarmAdd(TimerNow()), frameMinutes(&payload[1 + 2 * i]));
+        break;
 
-            if (displayState == DISPLAY_CLOCK)
-                printTime(clockHH, clockMM);
-        }   
+    default:
+        status = PROTO_ERR_COMMAND;
+        break;
     }
 
-    // Commented to prevent compiler warning
-    // return(0);
+    if (status == PROTO_OK && command != PROTO_QUERY)
+        dispatch(EVENT_ALARMS_CHANGED);
+
+    reply[0] = (uint8_t)status;
+    ProtoReply(command | PROTO_REPLY, reply, replyLength);
+
+    // The reply has moved the terminal cursor
+    ScreenInvalidate();
 }
 
-void SysTick_Handler(void)
+// Minutes field of a frame; little endian
+static uint32_t frameMinutes(const uint8_t * const field)
 {
-    CurrentTicks++;
+    return field[0] | ((uint32_t)field[1] << 8);
 }
 
-// Handle SW1/SW2 pressed
-void GPIOF_Handler(void)
+// Reschedule the alarm timers and show whatever DisplayState calls for
+static void showAlarms(void)
 {
-    if (GPIOF->MIS & 0x10)      // SW1 pressed.
+    scheduleAlarms();
+    scheduleSave();
+
+    if (DisplayState == DISPLAY_ALARM)
     {
-        GPIOF->ICR |= (1 << 4); // Clear the interrupt
-        enqueue(1);
+#ifdef COUNTDOWN_SECONDS
+        uint32_t remaining = alarmRemaining(Selected);
+
+        if (remaining <= COUNTDOWN_SECONDS)
+        {
+            uint32_t seconds = (remaining + DELAY_TIME_1 - 1) / DELAY_TIME_1;
+            printCountdown(seconds / 60, seconds % 60);
+        }
+        else
+#endif
+        {
+            uint32_t minutes = alarmMinutes(Selected);
+            printTime(minutes / 60, minutes % 60);
+        }
     }
-    else if (GPIOF->MIS & 0x01) // SW2 pressed.
-    {   
-        GPIOF->ICR |= (1 << 0); // Clear the interrupt
-        enqueue(2);
+    else if (DisplayState == DISPLAY_ALARM_INIT)
+    {
+        printTime(0, 0);
+    }
+    else
+    {
+        printTime(ClockHH, ClockMM);
     }
 }
 
-static void enqueue(const int32_t switchPressed)
+// The clock is read from the RTC every minute; reading it again is harmless (see RtcHandler())
+static void clockMinute(void)
 {
-    if (RearQueue == MESSAGE_QUEUE_SZ - 1)
+    uint32_t seconds = RtcSeconds();
+
+    ClockHH = seconds / 3600;
+    ClockMM = seconds / 60 % 60;
+
+    dispatch(EVENT_MINUTE);
+}
+
+// The nearest alarm has gone off. Only the top of the heap is examined; several alarms may expire together.
+static void alarmTimeout(const uint32_t id)
+{
+    uint32_t now = TimerNow();
+    uint32_t alarm;
+
+    (void)id;
+
+    while ((alarm = AlarmNearest()) != ALARM_NONE && (int32_t)(AlarmExpiry(alarm) - now) <= 0)
     {
+        AlarmCancel(alarm);
+        ledShow(LED_ALARM);
     }
-    else
+
+    dispatch(EVENT_ALARMS_CHANGED);
+}
+
+// We can be in DISPLAY_ALARM_INIT for 10 seconds only
+static void alarmInitTimeout(const uint32_t id)
+{
+    (void)id;
+
+    dispatch(EVENT_INIT_TIMEOUT);
+}
+
+// Next step of the led pattern; the pattern switches the leds off when it has finished
+static void ledTimeout(const uint32_t id)
+{
+    uint32_t time = LedStep();
+
+    TRACE_RECORD(TRACE_LED, LedCurrent());
+    if (time != 0)
+        TimerStart(id, time, ledTimeout);
+}
+
+// The selected alarm's countdown has moved on a minute (or, in its last COUNTDOWN_SECONDS, a second)
+static void displayTimeout(const uint32_t id)
+{
+    (void)id;
+
+    dispatch(EVENT_COUNTDOWN);
+}
+
+// Checkpoint the alarms: each expiry as the RTC count it falls on, to the nearest second
+static void saveTimeout(const uint32_t id)
+{
+    uint32_t expiry[ALARM_COUNT];
+    uint32_t now = TimerNow();
+    uint32_t rtc = RtcCounter();
+    uint32_t alarm;
+
+    (void)id;
+
+    for (alarm = 0; alarm < ALARM_COUNT; alarm++)
     {
-        if (FrontQueue == -1 && RearQueue == -1)
-        {
-            FrontQueue = RearQueue = 0;
-        }
+        int32_t remaining = (int32_t)(AlarmExpiry(alarm) - now);
+
+        if (!AlarmActive(alarm))
+            expiry[alarm] = STATE_NO_ALARM;
         else
-        {
-            RearQueue++;
-        }
-        MessageQueue[RearQueue].switchPressed = switchPressed;
-        MessageQueue[RearQueue].switchPressedTime = CurrentTicks;
+            expiry[alarm] = rtc + (remaining > 0 ? ((uint32_t)remaining + 500) / 1000 : 0);
     }
-}    
 
-static void dequeue(int32_t * const switchPressed,
-                    int32_t * const switchPressedTime)
+    // A failed write is not retried until the alarms change again
+    StateSave(expiry);
+
+    SavedChanges = AlarmChanges();
+    LastSave = now;
+}
+
+#ifdef CLOCK_BURST
+// UART0 has been quiet for CLOCK_QUIET_TIME
+static void clockTimeout(const uint32_t id)
 {
-    *switchPressed = -1;
-    if (FrontQueue == -1 && RearQueue == -1)
-        return;
-    
-    *switchPressed = MessageQueue[FrontQueue].switchPressed;
-    *switchPressedTime = MessageQueue[FrontQueue].switchPressedTime;
-    
-    MessageQueue[FrontQueue].switchPressed = -1;
-    if (FrontQueue == RearQueue)
-        FrontQueue = RearQueue = -1;
-    else
-        FrontQueue++;
-}    
+    (void)id;
 
-static void setup_leds(void)
+    ClockSetProfile(CLOCK_16MHZ);
+}
+#endif
+
+#ifdef DIAG_ITM
+// Give the dumps held back by a busy stimulus port another go
+static void diagTimeout(const uint32_t id)
 {
-    GPIOF->DIR |= (1 << 1);       // Set PF1 as digital output to control red LED
-    GPIOF->DEN |= (1 << 1);       // Set PF1 as digital pin
+    (void)id;
+
+    SchedPost(TASK_REPORTS);
 }
+#endif
 
-static void setup_switch1(void)
+#ifdef BENCHMARK
+// Drive the next synthetic press or release (see benchrtns.c)
+static void benchTimeout(const uint32_t id)
 {
-    // Initialize PF4 as digital input pin
-    GPIOF->DIR &= ~(1U << 4);     // Set PF4 as a digital input pin
-    GPIOF->DEN |= (1 << 4);       // Set PF4 as digital pin
-    GPIOF->PUR |= (1 << 4);       // Enable pull-up for PF4
-    
-    // Configure PF4 for falling edge trigger interrupt
-    GPIOF->IS  &= ~(1U << 4);     // make bit 4 edge sensitive
-    GPIOF->IBE &= ~(1U << 4);     // trigger is controlled by IEV
-    GPIOF->IEV &= ~(1U << 4);     // falling edge trigger
-    GPIOF->ICR |= (1 << 4);       // clear any prior interrupt
-    GPIOF->IM  |= (1 << 4);       // unmask interrupt
-    
-    // Configure interrupt.
-    // Set Interrupt Clear Register (Receive Interrupt Clear)
-    // Set Interrupt Mask Register
-    // Set Interrupt Set Enable Register through NVIC i.e. the interrupt must be enabled in the NVIC_ENm_R register.
-    // Each NVIC_ENm_R register has 32-bits, and each bit controls one interrupt number. Using the following formula to find out NVIC_ENm_R register number
-    // and the bit number to enable the interrupt on NVIC.
-    // m = interrupt number / 32
-    // b = interrupt number % 32
-    // NVIC->ISER[m] |= (1UL << b);
-    // For GPIOF, the interrupt number is 30 (see startup_TM4C123.s; look for GPIOF_Handler; you will find "30: GPIO Port F")
-    // m = 30 / 32 = 0; hence we update ISER[0]; b = 30 % 32 = 30; hence we set bit 30.
-    NVIC->IP[30] = 3 << 5;      // Set interrupt priority to 3
-    NVIC->ISER[0] |= (1 << 30); // Enable IRQ30
-}
-
-static void setup_switch2(void)
-{
-	// PF0 has special function, need to unlock to modify
-    GPIOF->LOCK = 0x4C4F434B;   // Unlock commit register
-    GPIOF->CR = 0x01;           // Make PF0 configurable
-    GPIOF->LOCK = 0;            // Lock commit register
-
-    // Initialize PF0 as digital input pin
-    GPIOF->DIR &= ~(1U << 0);  // Set PF0 as a digital input pin
-    GPIOF->DEN |= (1 << 0);   // Set PF0 as digital pin
-    GPIOF->PUR |= (1 << 0);   // Enable pull-up for PF0
-    
-    // Configure PF0 for falling edge trigger interrupt
-    GPIOF->IS  &= ~(1U << 0);        // make bit 0 edge sensitive
-    GPIOF->IBE &= ~(1U << 0);        // trigger is controlled by IEV
-    GPIOF->IEV &= ~(1U << 0);        // falling edge trigger
-    GPIOF->ICR |= (1 << 0);         // clear any prior interrupt
-    GPIOF->IM  |= (1 << 0);         // unmask interrupt
-    
-    // Configure interrupt.
-    // Set Interrupt Clear Register (Receive Interrupt Clear)
-    // Set Interrupt Mask Register
-    // Set Interrupt Set Enable Register through NVIC i.e. the interrupt must be enabled in the NVIC_ENm_R register.
-    // Each NVIC_ENm_R register has 32-bits, and each bit controls one interrupt number. Using the following formula to find out NVIC_ENm_R register number
-    // and the bit number to enable the interrupt on NVIC.
-    // m = interrupt number / 32
-    // b = interrupt number % 32
-    // NVIC->ISER[m] |= (1UL << b);
-    // For GPIOF, the interrupt number is 30 (see startup_TM4C123.s; look for GPIOF_Handler; you will find "30: GPIO Port F")
-    // m = 30 / 32 = 0; hence we update ISER[0]; b = 30 % 32 = 30; hence we set bit 30.
-    NVIC->IP[30] = 3 << 5;     // Set interrupt priority to 3
-    NVIC->ISER[0] |= (1<<30);  // Enable IRQ30
-}
-
-static void setup_systick(void)
-{
-//Delay time calculation (assume 16MHz):
-//Since we are working with external clock i.e. 16 MHz, each pulse generated by the clock source will have:
-//1/XTAL frequency = 1/(16*10^6) = 62.5ns time period. 
-//So if we load 253 into the RELOAD register and trigger the counter it will count down with next pulse and will take 62.5ns to change its value from 253 to 252.
-//Hence, In order to generate the delay, we can calculate the approximate value that has to be loaded into this register by the formula-
-//Reload Value = XTAL*Time delay
-//one extra clock delay is already included to set the flag for rollover, hence we get one extra clock delay. By subtracting by one will give exact time delay.
-//Reload Value = (XTAL*Time Delay)-1
-//Remember that in one shoot, it can only take 0xFFFFFF maximum value (24 bits). Therefore in one shoot, we can only generate maximum of Time delay
-//TimeDelay = (ReloadValue+1)/XTAL=16777215+(1/(16*10^6))
-//TimeDelay = 1.048575937 sec.
-//Example: For generating 1us (0.000001 second) delay using 16MHz, the value that has to be loaded into the RELOAD Register
-//Reload Value = (XTAL*Time delay)-1
-//Reload Value = (16*10^6*.000001)-1
-//Reload Value = 15
-//Example: For generating 1ms (0.001 second) delay using 16MHz, the value that has to be loaded into the RELOAD Register
-//Reload Value = (XTAL*Time delay)-1
-//Reload Value = (16*10^6*.001)-1
-//Reload Value = 15999
-//Example: For generating 1 second delay using 16MHz, the value that has to be loaded into the RELOAD Register
-//Reload Value = (XTAL*Time delay)-1
-//Reload Value = (16*10^6*1)-1
-//Reload Value = 15999999
-        
-    // We will generate 1ms time delay using 16MHz (CLOCK_SETUP is 0)
-    // Reload value = (16*10^6*.001)-1 = 15999
-    // Configure clock. See Tiva C DS page 123 (System Timer). For configuring CTRL see page 138 (Register 1);
-    // We need to set bits 0, 1, 2 i.e. 0111 == 07U or (1U << 2) | (1U << 1) | (1U)
-    SysTick->CTRL = 0;
-    SysTick->LOAD = 15999;  // Cannot exceed 24 bits i.e. 16777215
-    SysTick->VAL  = 0U;
-    SysTick->CTRL = (1 << 2) | (1 << 1) | (1 << 0);
+    TimerStart(id, BenchStep(), benchTimeout);
+    SchedPost(TASK_REPORTS);                // the step may have completed a report
 }
+#endif
 
-static void setup_uart0(void)
+// Milliseconds left on an alarm, worked out from its expiry whenever a frame or a reply needs it
+static uint32_t alarmRemaining(const uint32_t alarm)
 {
-    //1. Enable the UART module using the RCGCUART register (see page 344)
-    UartEnable(UART_0);
-    //2. To find out which GPIO port to enable, refer to Table 23-5 on page 1351. UART0 uses port A (U0Rx PA0 Pin 17, U0Tx PA1 Pin 18)
-    //   Enable the clock to the appropriate GPIO module via the RCGCGPIO register (see page 340).
-    GpioEnable(PORT_A);
-    //3. Set the GPIO AFSEL bits 0 and 1 (based on PA0 and PA1)for the appropriate pins (see page 671).
-    GPIOA->AFSEL = (1 << 1) | (1 << 0);
-    //4. Configure the GPIO current level and/or slew rate as specified for the mode selected (see page 673 and page 681).
-    // Not required
-    //5. Configure the PMCn fields in the GPIOPCTL register
-    GPIOA->PCTL  |= (1 << 0) | (1 << 4);
-    GPIOA->DEN   |= (1 << 0) | (1 << 1);
-
-    // Configure UART0
-    // The clock speed used to calculate IBRD/FBRD depends on the UARTCC Register setting of the UART Clock and if the PLL is used or not.
-    // If the UARTCC shows PIOSC clock (0x05) as the clock source, then it always is 16MHz and the Baud rate needs to be computed off it (CLOCK_SETUP value has no effect).
-    // IBRD=104, FBRD=11
-    // If the UARTCC shows the System Clock (0x00) as the clock source, then the RCC-RCC2 registers need to be checked to determine the System Clock and then compute the Baud Rate.
-    // CLOCK_SETUP = 1: Use 50MHz system clock, IBRD=325, FBRD=33
-    // CLOCK_SETUP = 0: Use 16MHz system clock, IBRD=104, FBRD=11
-    // In our code, we are using the 16MHz clock (UARTCC 0x00 with CLOCK_SETUP = 0) 
-    UART0->CTL  &= ~(1U << 0);
-    UART0->CC   = 0x0;
-    UART0->IBRD = 104;
-    UART0->FBRD = 11;
-    UART0->LCRH = (0x3 << 5);
-    UART0->CTL  = (1 << 0) | (1 << 8) | (1 << 9);
-
-    // Configure interrupt.
-    // Set Interrupt Clear Register (Receive Interrupt Clear)
-    // Set Interrupt Mask Register
-    // Set Interrupt Set Enable Register through NVIC i.e. the interrupt must be enabled in the NVIC_ENm_R register.
-    // Each NVIC_ENm_R register has 32-bits, and each bit controls one interrupt number. Using the following formula to find out NVIC_ENm_R register number
-    // and the bit number to enable the interrupt on NVIC.
-    // m = interrupt number / 32
-    // b = interrupt number % 32
-    // NVIC->ISER[m] |= (1UL << b);
-    // For UART0, the interrupt number is 5 (see startup_TM4C123.s; look for UART0_Handler; you will find "5: UART0 Rx and Tx")
-    // m = 5 / 32 = 0; hence we update ISER[0]; b = 5 % 32 = 5; hence we set bit 5.
-    UART0->ICR &= ~(1U << 4);
-    UART0->IM |= (1 << 4);
-    NVIC->ISER[0] = (1 << 5);
+    int32_t remaining = (int32_t)(AlarmExpiry(alarm) - TimerNow());
+
+    return (remaining > 0) ? (uint32_t)remaining : 0;
 }
 
-void UART0_Handler(void)
+// Minutes left on an alarm, rounded up, so an alarm set for 5 minutes shows 5 until it has 4 minutes left
+static uint32_t alarmMinutes(const uint32_t alarm)
 {
-    Uart0Char = readChar();
-    UartActionReqd = 1;
+    return (alarmRemaining(alarm) + DELAY_TIME_60 - 1) / DELAY_TIME_60;
 }
 
-static char readChar(void)
+// Changing an alarm restarts its countdown: the alarm goes off the given number of minutes from now
+static void setAlarmMinutes(const uint32_t alarm,
+                            const uint32_t minutes)
 {
-    char c;
-    while ((UART0->FR & (1 << 4)) != 0);
-    c = UART0->DR;
-    return c;
+    AlarmSet(alarm, TimerNow() + minutes * DELAY_TIME_60);
 }
 
-static void incrementTime(uint32_t * const hh,
-                          uint32_t * const mm)
+// TIMER_ALARM follows the nearest alarm in the heap and TIMER_DISPLAY the next minute boundary of the
+// selected alarm, or the next second boundary in its last COUNTDOWN_SECONDS (the alarm itself takes care of
+// its last minute or second). Nothing runs per alarm in between.
+static void scheduleAlarms(void)
 {
-    *mm += 1;
-    if (*mm == 60)
+    uint32_t alarm = AlarmNearest();
+
+    if (alarm == ALARM_NONE)
+        TimerCancel(TIMER_ALARM);
+    else
+        TimerStart(TIMER_ALARM, alarmRemaining(alarm), alarmTimeout);
+
+    TimerCancel(TIMER_DISPLAY);
+    if (DisplayState == DISPLAY_ALARM && AlarmActive(Selected))
     {
-        *hh += 1;
-        if (*hh == 24) *hh = 0;
-        *mm = 0;
+        uint32_t left = alarmRemaining(Selected);
+        uint32_t step = DELAY_TIME_60;
+
+#ifdef COUNTDOWN_SECONDS
+        if (left <= COUNTDOWN_SECONDS)
+            step = DELAY_TIME_1;
+#endif
+        if (left > step)
+            TimerStart(TIMER_DISPLAY, (left - 1) % step + 1, displayTimeout);
     }
 }
 
-static void decrementTime(uint32_t * const hh,
-                          uint32_t * const mm)
+// Start TIMER_SAVE if the alarms have changed since the last checkpoint, for SAVE_INTERVAL after it
+static void scheduleSave(void)
 {
-    if (*hh == 0 && *mm == 0)
+    int32_t wait;
+
+    if (AlarmChanges() == SavedChanges || TimerActive(TIMER_SAVE))
         return;
 
-    if (*mm == 0)
-    {
-        *hh -= 1;
-        *mm = 59;
-    }
-    else
+    wait = (int32_t)(LastSave + SAVE_INTERVAL - TimerNow());
+    TimerStart(TIMER_SAVE, wait > 0 ? (uint32_t)wait : 0, saveTimeout);
+}
+
+// Restart the alarms of the last checkpoint with the time spent in reset and power off taken off their
+// countdowns. An alarm that would have gone off in the meantime goes off now.
+static void resumeAlarms(void)
+{
+    uint32_t expiry[ALARM_COUNT];
+    uint32_t rtc = RtcCounter();
+    uint32_t i;
+
+    if (!StateLoad(expiry))
+        return;
+
+    for (i = 0; i < ALARM_COUNT; i++)
     {
-        *mm -= 1;
+        int32_t remaining = (int32_t)(expiry[i] - rtc);
+
+        if (expiry[i] == STATE_NO_ALARM)
+            continue;
+
+        // A damaged or foreign checkpoint could be any distance ahead; no alarm is longer than ALARM_MAX_MINUTES
+        if (remaining < 0)
+            remaining = 0;
+        else if (remaining > ALARM_MAX_MINUTES * 60)
+            remaining = ALARM_MAX_MINUTES * 60;
+        AlarmAdd(TimerNow() + (uint32_t)remaining * 1000);
     }
+
+    // The log already holds these
+    SavedChanges = AlarmChanges();
+}
+
+void WTIMER0A_Handler(void)
+{
+    TRACE_RECORD(TRACE_TICK, 0);
+    TimerHandler();
+    SchedPost(TASK_TIMERS);
+}
+
+// Handle SW1/SW2 pressed
+void WTIMER0B_Handler(void)
+{
+    PROF_START(start);
+    TRACE_RECORD(TRACE_DEBOUNCE, 0);
+    InputDebounceHandler();
+    if (!QueueEmpty())
+        SchedPost(TASK_EVENTS);
+    PROF_STOP(PROF_WTIMER0B_ISR, start);
+}
+
+void GPIOF_Handler(void)
+{
+    PROF_START(start);
+#ifdef BENCHMARK
+    BenchEdge();
+#endif
+    TRACE_RECORD(TRACE_EDGE, GPIO_PORTF->MIS);
+    InputHandler(PORT_F);
+    PROF_STOP(PROF_GPIOF_ISR, start);
+}
+
+#ifdef KEYPAD
+void KEYPAD_ROW_HANDLER(void)
+{
+    InputHandler(KEYPAD_ROW_PORT);
+}
+#endif
+
+static void setup_leds(void)
+{
+    // PF1-PF3 are driven by PWM1 (see ledrtns.c). To find the PMCn value, refer to Table 23-5 on page 1351:
+    // M1PWM5-7 are function 5.
+    GPIO_PORTF->AFSEL |= LED_PINS;                                      // Alternate function on PF1-PF3
+    GPIO_PORTF->PCTL  = (GPIO_PORTF->PCTL & ~0xFFF0U) | 0x5550U;        // PMC1-PMC3 = 5
+    GPIO_PORTF->DEN   |= LED_PINS;                                      // Set PF1-PF3 as digital pins
 }
 
+static void setup_uart0(void)
+{
+    // UartInit() follows 14.4 Initialization and Configuration with the UART0 entry of its configuration: U0Rx PA0
+    // and U0Tx PA1 (Table 23-5), the UART0_BAUD divisors for the clock profile and interrupt number 5 (see
+    // startup_TM4C123.s; look for UART0_Handler; you will find "5: UART0 Rx and Tx"). UARTCC selects the system
+    // clock, so ClockSetProfile() switches the divisors (UartSetClock()) when the system clock changes.
+    // Interrupt when the receive FIFO is half full (or on receive time-out) and when the transmit FIFO is down to
+    // 2 characters.
+    UartInit(UART_0, UART_FIFO_1_2, UART_FIFO_1_8, UART_TX_DROP_NEWEST);
+}
+
+void HIB_Handler(void)
+{
+    PROF_START(start);
+    RtcHandler();
+    if (!QueueEmpty())
+        SchedPost(TASK_EVENTS);
+    PROF_STOP(PROF_HIB_ISR, start);
+}
+
+void UART0_Handler(void)
+{
+    PROF_START(start);
+    UartRxHandler(UART_0);          // Receive FIFO (or receive time-out) to receive ring buffer
+    UartTxHandler(UART_0);          // Transmit ring buffer (and uDMA completion)
+    if (UartRxAvailable(UART_0))
+        SchedPost(TASK_COMMANDS);
+    SchedPost(TASK_REPORTS);
+    PROF_STOP(PROF_UART0_ISR, start);
+}
+
+
 static void printTime(const uint32_t hh,
                       const uint32_t mm)
 {
-    char timeString[6 + 1];
-    sprintf(timeString, "%2d:%02d\r", hh, mm);
-    printString(timeString);
+    PROF_START(start);
+    ScreenTime(hh, mm);
+    PROF_STOP(PROF_PRINT_TIME, start);
 }
 
-static void printString(const char * string)
+#ifdef COUNTDOWN_SECONDS
+static void printCountdown(const uint32_t mm,
+                           const uint32_t ss)
 {
-    while (*string)
-    {
-        printChar(*(string++));
-    }
+    PROF_START(start);
+    ScreenCountdown(mm, ss);
+    PROF_STOP(PROF_PRINT_TIME, start);
 }
+#endif
 
-static void printChar(const char c)
+#if defined(PROFILE) || defined(TRACE) || defined(MEMORY_REPORT) || defined(BANNER)
+// Send the string on a diagnostic channel (see diagrtns.h); this does not wait for it to be sent.
+static void printDiag(const diag_channel_t channel,
+                      const char * string)
 {
-    while ((UART0->FR & (1 << 5)) != 0);
-    UART0->DR = c;
+    PROF_START(start);
+    DiagWrite(channel, string);
+    PROF_STOP(PROF_DIAG, start);
 }
+#endif
+
+#ifdef BANNER
+// "\n\r<clock> Hz <boot> us\n\r", then the frame again on the new line
+static void printBanner(const uint32_t cycles)
+{
+    char banner[2 + FMT_UNSIGNED_SZ + 4 + FMT_UNSIGNED_SZ + 5];
+    const char * unit;
+    uint32_t length = 0;
 
+    banner[length++] = '\n';
+    banner[length++] = '\r';
+    length += FmtUnsigned(&banner[length], ClockRead());
+    for (unit = " Hz "; *unit; unit++)
+        banner[length++] = *unit;
+    length += FmtUnsigned(&banner[length], cycles / (ClockHz() / 1000000));
+    for (unit = " us\n\r"; *unit; unit++)
+        banner[length++] = *unit;
+    banner[length] = '\0';
+    printDiag(DIAG_BANNER, banner);
+
+#ifndef DIAG_ITM
+    ScreenInvalidate();
+    showAlarms();
+#endif
+}
+#endif
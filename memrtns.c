@@ -0,0 +1,140 @@
+// RAM high-water marks, so that the stack, the event queue and the UART ring buffers can be sized from what
+// the firmware has actually used rather than by guesswork.
+//
+// MemInit() paints the free part of the stack with MEM_PAINT before anything else runs; the deepest the stack
+// has been is then the lowest word that no longer holds the paint. The stack is the STACK section of
+// startup_TM4C123.s; armlink provides its bounds as STACK$$Base and STACK$$Limit. A row is only right if a
+// real stack overflow has not run past STACK$$Base, in which case the peak reads as the whole stack.
+//
+// The rings wrap, so paint cannot show how full they have been; the queue and the UART keep their own peak
+// counts (QueueHighWater(), UartRxHighWater(), UartTxHighWater()).
+//
+// 'm' dumps a row per resource: its name, the peak, the size and the number of items dropped, in bytes for the
+// stack and the UART rings and in events for the queue. As for the profiling table (see ProfService()) a row is
+// only queued when the DIAG_MEMORY channel has room for it.
+
+#include "TM4C123GH6PM.h"
+
+#include "diagrtns.h"
+#include "fmtrtns.h"
+#include "memrtns.h"
+#include "queuertns.h"
+#include "uartrtns.h"
+
+#ifdef MEMORY_REPORT
+
+#define MEM_PAINT               0xC5C5C5C5
+
+typedef enum
+{
+    MEM_STACK = 0,
+    MEM_QUEUE,
+    MEM_UART0_RX,
+    MEM_UART0_TX,
+    MEM_ROW_COUNT
+} mem_row_t;
+
+#define MEM_NOT_DUMPING         MEM_ROW_COUNT
+
+// Longest name, three numbers with a leading space each, "\n\r" and the NUL
+#define MEM_ROW_SZ              (7 + 3 * (1 + FMT_UNSIGNED_SZ - 1) + 2 + 1)
+
+static const char * const Names[MEM_ROW_COUNT] =
+{
+    "stack", "queue", "uart0rx", "uart0tx"
+};
+
+extern uint32_t STACK$$Base;
+extern uint32_t STACK$$Limit;
+
+static uint32_t Dumping = MEM_NOT_DUMPING;      // next row to send
+
+static uint32_t stackPeak(void);
+
+// Call first thing in main(): everything below the current stack pointer is unused
+void MemInit(void)
+{
+    uint32_t * word = &STACK$$Base;
+    uint32_t * const sp = (uint32_t *)__get_MSP();
+
+    while (word < sp)
+        *word++ = MEM_PAINT;
+}
+
+void MemDump(void)
+{
+    Dumping = 0;
+}
+
+// Called from the main loop; sends the next rows of a dump. Returns 1 once the last row has been queued.
+uint32_t MemService(void)
+{
+    while (Dumping < MEM_ROW_COUNT)
+    {
+        char row[MEM_ROW_SZ];
+        const char * name = Names[Dumping];
+        uint32_t length = 0;
+        uint32_t peak;
+        uint32_t size;
+        uint32_t dropped;
+
+        switch (Dumping)
+        {
+        case MEM_STACK:
+            peak = stackPeak();
+            size = (uint32_t)((const uint8_t *)&STACK$$Limit - (const uint8_t *)&STACK$$Base);
+            dropped = 0;
+            break;
+
+        case MEM_QUEUE:
+            peak = QueueHighWater();
+            size = EVENT_QUEUE_SZ;
+            dropped = QueueDropped();
+            break;
+
+        case MEM_UART0_RX:
+            peak = UartRxHighWater(UART_0);
+            size = UART_RX_BUFFER_SZ;
+            dropped = UartRxDropped(UART_0);
+            break;
+
+        default:
+            peak = UartTxHighWater(UART_0);
+            size = UART_TX_BUFFER_SZ;
+            dropped = UartTxDropped(UART_0);
+            break;
+        }
+
+        while (*name)
+            row[length++] = *name++;
+        length = FmtAppendUnsigned(row, length, peak);
+        length = FmtAppendUnsigned(row, length, size);
+        length = FmtAppendUnsigned(row, length, dropped);
+        row[length++] = '\n';
+        row[length++] = '\r';
+        row[length] = '\0';
+
+        if (DiagSpace(DIAG_MEMORY) < length)
+            return 0;
+
+        DiagWrite(DIAG_MEMORY, row);
+        if (++Dumping == MEM_ROW_COUNT)
+        {
+            Dumping = MEM_NOT_DUMPING;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Bytes from the top of the stack down to the lowest word that has been written since MemInit()
+static uint32_t stackPeak(void)
+{
+    const uint32_t * word = &STACK$$Base;
+
+    while (word < &STACK$$Limit && *word == MEM_PAINT)
+        word++;
+    return (uint32_t)((const uint8_t *)&STACK$$Limit - (const uint8_t *)word);
+}
+
+#endif // MEMORY_REPORT
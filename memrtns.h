@@ -0,0 +1,15 @@
+#ifndef MEMRTNS_H
+#define MEMRTNS_H
+
+#include "stdint.h"
+
+// Define MEMORY_REPORT to paint the stack at reset and report the RAM high-water marks: the deepest the stack
+// has been, the most events queued and the fullest the UART0 ring buffers have been (see memrtns.c). The 'm'
+// command dumps them.
+// #define MEMORY_REPORT
+
+void MemInit                    (void);
+void MemDump                    (void);
+uint32_t MemService             (void);
+
+#endif // MEMRTNS_H
@@ -0,0 +1,57 @@
+// Batched peripheral clock gating; see 5.2.6 System Control and Register 8: RCC (ACG).
+//
+// The run mode clocks of every module are enabled first (RCGCx) and the peripheral ready registers (PRx) are
+// polled once afterwards, so the modules come out of reset together instead of one after another. The sleep
+// and deep-sleep masks are written to SCGCx and DCGCx as they are, i.e. a module not in the mask stops while
+// the processor sleeps; RCC ACG makes the hardware use them (otherwise RCGCx applies in every mode).
+//
+// The module init routines (GpioEnable(), UartEnable(), TimerInit(), ...) still enable their own clock, which
+// costs nothing once PeriphEnable() has done it.
+
+#include "TM4C123GH6PM.h"
+
+#include "periphrtns.h"
+
+#define RCC_ACG                 (1U << 27)
+
+void PeriphEnable(const periph_mask_t * const run,
+                  const periph_mask_t * const sleep,
+                  const periph_mask_t * const deepSleep)
+{
+    SYSCTL->RCGCGPIO   |= run->gpio;
+    SYSCTL->RCGCUART   |= run->uart;
+    SYSCTL->RCGCTIMER  |= run->timer;
+    SYSCTL->RCGCWTIMER |= run->wtimer;
+    SYSCTL->RCGCHIB    |= run->hib;
+    SYSCTL->RCGCDMA    |= run->dma;
+    SYSCTL->RCGCPWM    |= run->pwm;
+
+    SYSCTL->SCGCGPIO   = sleep->gpio;
+    SYSCTL->SCGCUART   = sleep->uart;
+    SYSCTL->SCGCTIMER  = sleep->timer;
+    SYSCTL->SCGCWTIMER = sleep->wtimer;
+    SYSCTL->SCGCHIB    = sleep->hib;
+    SYSCTL->SCGCDMA    = sleep->dma;
+    SYSCTL->SCGCPWM    = sleep->pwm;
+
+    SYSCTL->DCGCGPIO   = deepSleep->gpio;
+    SYSCTL->DCGCUART   = deepSleep->uart;
+    SYSCTL->DCGCTIMER  = deepSleep->timer;
+    SYSCTL->DCGCWTIMER = deepSleep->wtimer;
+    SYSCTL->DCGCHIB    = deepSleep->hib;
+    SYSCTL->DCGCDMA    = deepSleep->dma;
+    SYSCTL->DCGCPWM    = deepSleep->pwm;
+
+    SYSCTL->RCC |= RCC_ACG;
+
+    // There must be a delay of 3 system clocks after a peripheral module clock is enabled in the RCGC register
+    // before any module registers are accessed. See page 227 (System Control). One pass over the PR registers
+    // covers every module enabled above.
+    while ((SYSCTL->PRGPIO   & run->gpio)   != run->gpio   ||
+           (SYSCTL->PRUART   & run->uart)   != run->uart   ||
+           (SYSCTL->PRTIMER  & run->timer)  != run->timer  ||
+           (SYSCTL->PRWTIMER & run->wtimer) != run->wtimer ||
+           (SYSCTL->PRHIB    & run->hib)    != run->hib    ||
+           (SYSCTL->PRDMA    & run->dma)    != run->dma    ||
+           (SYSCTL->PRPWM    & run->pwm)    != run->pwm);
+}
@@ -0,0 +1,23 @@
+#ifndef PERIPHRTNS_H
+#define PERIPHRTNS_H
+
+#include "stdint.h"
+
+// Peripheral modules to clock, one mask per class: bit n is module n, e.g. (1 << PORT_F) for GPIO Port F or
+// (1 << UART_0) for UART0.
+typedef struct
+{
+    uint32_t gpio;
+    uint32_t uart;
+    uint32_t timer;             // 16/32 bit timers
+    uint32_t wtimer;            // 32/64 bit wide timers
+    uint32_t hib;
+    uint32_t dma;
+    uint32_t pwm;
+} periph_mask_t;
+
+void PeriphEnable               (const periph_mask_t * const run,
+                                 const periph_mask_t * const sleep,
+                                 const periph_mask_t * const deepSleep);
+
+#endif // PERIPHRTNS_H
@@ -0,0 +1,135 @@
+// Opt-in region profiling on the DWT cycle counter (see the ARMv7-M Architecture Reference Manual, C1.8 Data
+// Watchpoint and Trace unit).
+//
+// CYCCNT counts processor clocks, so the figures are cycles at whatever clock profile was selected. A region
+// is timed by PROF_START() / PROF_STOP(); the cost of the two calls themselves is measured once by ProfInit()
+// and taken off every sample. Each region keeps its call count, minimum, maximum and total, from which the
+// dump works out the mean.
+//
+// Every region is recorded from one context only (one handler or the main loop), so an interrupt can never
+// update the entry that is being updated underneath it. A dump reads the table while the handlers keep
+// recording; a row may mix two consecutive samples.
+//
+// The dump is written one row at a time by ProfService(), and only when the DIAG_PROFILE channel (the UART0
+// transmit ring unless DIAG_ITM is defined; see diagrtns.h) has room for the whole row, so it is never truncated
+// by the ring's overflow policy.
+
+#include "TM4C123GH6PM.h"
+
+#include "diagrtns.h"
+#include "fmtrtns.h"
+#include "profrtns.h"
+
+#ifdef PROFILE
+
+#define PROF_NOT_DUMPING        PROF_REGION_COUNT
+
+// Longest name, four numbers with a leading space each, "\n\r" and the NUL
+#define PROF_ROW_SZ             (8 + 4 * (1 + FMT_UNSIGNED_SZ - 1) + 2 + 1)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} prof_entry_t;
+
+static const char * const Names[PROF_REGION_COUNT] =
+{
+    "task", "queue", "switch", "command", "print", "diag", "gpiof", "wtimer0b", "hib", "uart0"
+};
+
+static prof_entry_t Table[PROF_REGION_COUNT];
+static uint32_t Overhead;
+static uint32_t Dumping = PROF_NOT_DUMPING;    // next row to send
+
+void ProfInit(void)
+{
+    uint32_t start;
+
+    CoreDebug->DEMCR |= DEMCR_TRCENA;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA;
+
+    // An empty region
+    start = ProfCycles();
+    Overhead = ProfCycles() - start;
+
+    ProfReset();
+}
+
+uint32_t ProfCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+// End a region started (PROF_START) at start
+void ProfRecord(const prof_region_t region,
+                const uint32_t start)
+{
+    uint32_t cycles = ProfCycles() - start;
+    prof_entry_t * const entry = &Table[region];
+
+    cycles = (cycles > Overhead) ? cycles - Overhead : 0;
+
+    entry->count++;
+    entry->total += cycles;
+    if (cycles < entry->min)
+        entry->min = cycles;
+    if (cycles > entry->max)
+        entry->max = cycles;
+}
+
+void ProfReset(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < PROF_REGION_COUNT; i++)
+    {
+        Table[i].count = 0;
+        Table[i].min   = 0xFFFFFFFF;
+        Table[i].max   = 0;
+        Table[i].total = 0;
+    }
+}
+
+// Start sending the table: "name count min max mean" per region
+void ProfDump(void)
+{
+    Dumping = 0;
+}
+
+// Called from the main loop; sends the next rows of a dump. Returns 1 once the last row has been queued.
+uint32_t ProfService(void)
+{
+    while (Dumping < PROF_REGION_COUNT)
+    {
+        const prof_entry_t * const entry = &Table[Dumping];
+        char row[PROF_ROW_SZ];
+        const char * name = Names[Dumping];
+        uint32_t length = 0;
+
+        while (*name)
+            row[length++] = *name++;
+        length = FmtAppendUnsigned(row, length, entry->count);
+        length = FmtAppendUnsigned(row, length, entry->count ? entry->min : 0);
+        length = FmtAppendUnsigned(row, length, entry->max);
+        length = FmtAppendUnsigned(row, length, entry->count ? (uint32_t)(entry->total / entry->count) : 0);
+        row[length++] = '\n';
+        row[length++] = '\r';
+        row[length] = '\0';
+
+        if (DiagSpace(DIAG_PROFILE) < length)
+            return 0;
+
+        DiagWrite(DIAG_PROFILE, row);
+        if (++Dumping == PROF_REGION_COUNT)
+        {
+            Dumping = PROF_NOT_DUMPING;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif // PROFILE
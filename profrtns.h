@@ -0,0 +1,45 @@
+#ifndef PROFRTNS_H
+#define PROFRTNS_H
+
+#include "stdint.h"
+
+// Define PROFILE to time the regions below with the DWT cycle counter. The 'p' command dumps the table.
+// #define PROFILE
+
+// Debug register bits shared by the users of the DWT cycle counter and the ITM (profiling, the benchmark, the
+// boot banner and the SWO diagnostics); see the ARMv7-M Architecture Reference Manual, C1.6.5 and C1.8.7
+#define DEMCR_TRCENA            (1UL << 24)     // CoreDebug DEMCR: enable the DWT and ITM
+#define DWT_CTRL_CYCCNTENA      (1UL << 0)      // DWT CTRL: enable CYCCNT
+
+typedef enum
+{
+    PROF_TASK = 0,              // one task run by the main loop (see schedrtns.h)
+    PROF_QUEUE_GET,             // QueueGet()
+    PROF_SWITCH,                // state transition on a switch event
+    PROF_COMMAND,               // state transition on a UART0 command or frame
+    PROF_PRINT_TIME,            // printTime()
+    PROF_DIAG,                  // printDiag() i.e. a diagnostic channel write
+    PROF_GPIOF_ISR,             // GPIOF_Handler, entry to exit
+    PROF_WTIMER0B_ISR,
+    PROF_HIB_ISR,
+    PROF_UART0_ISR,
+    PROF_REGION_COUNT
+} prof_region_t;
+
+#ifdef PROFILE
+#define PROF_START(start)           const uint32_t start = ProfCycles()
+#define PROF_STOP(region, start)    ProfRecord((region), (start))
+#else
+#define PROF_START(start)
+#define PROF_STOP(region, start)
+#endif
+
+void ProfInit                   (void);
+uint32_t ProfCycles             (void);
+void ProfRecord                 (const prof_region_t region,
+                                 const uint32_t start);
+void ProfReset                  (void);
+void ProfDump                   (void);
+uint32_t ProfService            (void);
+
+#endif // PROFRTNS_H
@@ -0,0 +1,174 @@
+// Incremental parser for the framed UART0 commands described in protortns.h.
+//
+// ProtoFeed() takes the characters read from the UART0 receive ring one at a time, so a frame can arrive over
+// any number of main loop passes and is only handed over once its CRC has been checked. A frame is then held
+// until the next character is fed; the caller applies it (e.g. a whole alarm schedule) in the same pass.
+// Frames with a bad CRC or length are dropped and counted; the host repeats a request that is not answered.
+// After an error the frame boundaries are lost, so the characters that follow are discarded until the next
+// PROTO_SOF or until the line has been quiet for PROTO_TIMEOUT: what is left of a broken frame must not reach
+// the caller as single character commands.
+
+#include "protortns.h"
+#include "timerrtns.h"
+#include "uartrtns.h"
+
+typedef enum
+{
+    PROTO_WAIT_SOF = 0,
+    PROTO_WAIT_LENGTH,
+    PROTO_WAIT_COMMAND,
+    PROTO_WAIT_PAYLOAD,
+    PROTO_WAIT_CRC_HIGH,
+    PROTO_WAIT_CRC_LOW,
+    PROTO_DISCARD               // after an error: swallow characters until PROTO_SOF or PROTO_TIMEOUT of quiet
+} proto_state_t;
+
+// PROTO_SOF, length, command, payload and CRC
+#define PROTO_FRAME_SZ          (3 + PROTO_PAYLOAD_SZ + 2)
+
+// CRC-16/CCITT-FALSE, four bits at a time
+static const uint16_t CrcNibble[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static proto_state_t State = PROTO_WAIT_SOF;
+static uint32_t LastFed;
+static uint8_t Length;
+static uint8_t Command;
+static uint8_t Payload[PROTO_PAYLOAD_SZ];
+static uint32_t Received;
+static uint16_t Crc;
+static uint16_t FrameCrc;
+static uint32_t Errors;
+
+static uint16_t crcUpdate(uint16_t crc,
+                          const uint8_t byte);
+
+proto_result_t ProtoFeed(const char c)
+{
+    uint8_t byte = (uint8_t)c;
+    uint32_t now = TimerNow();
+
+    // A stalled frame is an error, and the rest of it may still come; a new frame or a quiet line ends the
+    // discarding
+    if (State == PROTO_DISCARD && (byte == PROTO_SOF || now - LastFed > PROTO_TIMEOUT))
+        State = PROTO_WAIT_SOF;
+    else if (State != PROTO_WAIT_SOF && State != PROTO_DISCARD && now - LastFed > PROTO_TIMEOUT)
+    {
+        Errors++;
+        State = PROTO_DISCARD;
+    }
+    LastFed = now;
+
+    switch (State)
+    {
+    case PROTO_DISCARD:
+        break;
+
+    case PROTO_WAIT_SOF:
+        if (byte != PROTO_SOF)
+            return PROTO_NONE;
+        Crc = 0xFFFF;
+        State = PROTO_WAIT_LENGTH;
+        break;
+
+    case PROTO_WAIT_LENGTH:
+        if (byte > PROTO_PAYLOAD_SZ)
+        {
+            Errors++;
+            State = PROTO_DISCARD;
+            break;
+        }
+        Length = byte;
+        Crc = crcUpdate(Crc, byte);
+        State = PROTO_WAIT_COMMAND;
+        break;
+
+    case PROTO_WAIT_COMMAND:
+        Command = byte;
+        Received = 0;
+        Crc = crcUpdate(Crc, byte);
+        State = (Length == 0) ? PROTO_WAIT_CRC_HIGH : PROTO_WAIT_PAYLOAD;
+        break;
+
+    case PROTO_WAIT_PAYLOAD:
+        Payload[Received++] = byte;
+        Crc = crcUpdate(Crc, byte);
+        if (Received == Length)
+            State = PROTO_WAIT_CRC_HIGH;
+        break;
+
+    case PROTO_WAIT_CRC_HIGH:
+        FrameCrc = (uint16_t)(byte << 8);
+        State = PROTO_WAIT_CRC_LOW;
+        break;
+
+    case PROTO_WAIT_CRC_LOW:
+        if ((FrameCrc | byte) != Crc)
+        {
+            Errors++;
+            State = PROTO_DISCARD;
+            break;
+        }
+        State = PROTO_WAIT_SOF;
+        return PROTO_FRAME;
+    }
+
+    return PROTO_PENDING;
+}
+
+// Command of the frame ProtoFeed() has just completed
+uint32_t ProtoCommand(void)
+{
+    return Command;
+}
+
+// Payload of the frame ProtoFeed() has just completed; valid until the next character is fed
+const uint8_t * ProtoPayload(uint32_t * const length)
+{
+    *length = Length;
+    return Payload;
+}
+
+// Send a frame of up to PROTO_PAYLOAD_SZ payload bytes; the payload normally starts with a proto_status_t. The
+// frame is built here and queued with one write, so the transmitter is primed once rather than per byte.
+void ProtoReply(const uint32_t command,
+                const uint8_t * const payload,
+                const uint32_t length)
+{
+    char frame[PROTO_FRAME_SZ];
+    uint32_t size = 0;
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+
+    crc = crcUpdate(crc, (uint8_t)length);
+    crc = crcUpdate(crc, (uint8_t)command);
+    for (i = 0; i < length; i++)
+        crc = crcUpdate(crc, payload[i]);
+
+    frame[size++] = (char)PROTO_SOF;
+    frame[size++] = (char)length;
+    frame[size++] = (char)command;
+    for (i = 0; i < length; i++)
+        frame[size++] = (char)payload[i];
+    frame[size++] = (char)(crc >> 8);
+    frame[size++] = (char)(crc & 0xFF);
+
+    UartTxWriteBytes(UART_0, frame, size);
+}
+
+// Frames dropped for a bad length, a bad CRC or a time-out
+uint32_t ProtoErrors(void)
+{
+    return Errors;
+}
+
+static uint16_t crcUpdate(uint16_t crc,
+                          const uint8_t byte)
+{
+    crc = (uint16_t)((crc << 4) ^ CrcNibble[(crc >> 12) ^ (byte >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ CrcNibble[(crc >> 12) ^ (byte & 0x0F)]);
+    return crc;
+}
@@ -0,0 +1,54 @@
+#ifndef PROTORTNS_H
+#define PROTORTNS_H
+
+#include "stdint.h"
+
+// Framed binary commands on UART0, next to the single character commands:
+//
+//   PROTO_SOF | length | command | payload[length] | CRC high | CRC low
+//
+// The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) over length, command and payload.
+// Every valid frame is answered with a frame whose command is the request's command | PROTO_REPLY and whose
+// first payload byte is a proto_status_t. Multi-byte fields are little endian.
+#define PROTO_SOF               0xA5
+#define PROTO_REPLY             0x80
+#define PROTO_PAYLOAD_SZ        32
+
+// A frame that stalls for this long is abandoned
+#define PROTO_TIMEOUT           100     // milliseconds
+
+typedef enum
+{
+    PROTO_SET_CLOCK = 0x01,     // hh, mm
+    PROTO_ADD_ALARM,            // minutes (2 bytes); reply: status, id
+    PROTO_CANCEL_ALARM,         // id
+    PROTO_QUERY,                // reply: status, hh, mm, state, selected, count, count * (id, minutes (2 bytes))
+    PROTO_SCHEDULE              // count, count * minutes (2 bytes); replaces every running alarm
+} proto_command_t;
+
+typedef enum
+{
+    PROTO_OK = 0,
+    PROTO_ERR_COMMAND,          // unknown command
+    PROTO_ERR_LENGTH,           // wrong payload length for the command
+    PROTO_ERR_RANGE,            // a field is out of range
+    PROTO_ERR_FULL              // not enough free alarms
+} proto_status_t;
+
+// What ProtoFeed() did with a character
+typedef enum
+{
+    PROTO_NONE = 0,             // not part of a frame; handle it as a single character command
+    PROTO_PENDING,              // taken into the frame being received, or discarded after a bad frame
+    PROTO_FRAME                 // completed a valid frame; see ProtoCommand() and ProtoPayload()
+} proto_result_t;
+
+proto_result_t ProtoFeed        (const char c);
+uint32_t ProtoCommand           (void);
+const uint8_t * ProtoPayload    (uint32_t * const length);
+void ProtoReply                 (const uint32_t command,
+                                 const uint8_t * const payload,
+                                 const uint32_t length);
+uint32_t ProtoErrors            (void);
+
+#endif // PROTORTNS_H
@@ -0,0 +1,91 @@
+// Single-producer/single-consumer ring of events. No critical sections are needed because each index
+// has exactly one writer: QueueHead is only written by QueuePut() (interrupt context) and QueueTail only
+// by QueueGet() (main loop). The indices run freely and are masked on use, so the full queue can be used
+// and it never has to drain before accepting new events.
+// All producers must run at the same interrupt priority so that they cannot preempt each other.
+//
+// A slot packs the event into one word, (time << 8) | id, rather than an event_t padded to two: a store and a
+// load each way and half the RAM. QueueGet() recovers the top 8 bits of the time from TimerNow(), as the
+// event cannot be later than now.
+
+#include "TM4C123GH6PM.h"
+
+#include "queuertns.h"
+#include "timerrtns.h"
+
+#define EVENT_QUEUE_MASK        (EVENT_QUEUE_SZ - 1)
+
+#define EVENT_ID_BITS           8
+#define EVENT_ID_MASK           ((1U << EVENT_ID_BITS) - 1)
+
+#if (EVENT_QUEUE_SZ & EVENT_QUEUE_MASK) != 0
+#error "EVENT_QUEUE_SZ must be a power of two"
+#endif
+
+static uint32_t EventQueue[EVENT_QUEUE_SZ];
+static volatile uint32_t QueueHead;
+static volatile uint32_t QueueTail;
+
+// Statistics, written by the producer only
+static volatile uint32_t HighWater;
+static volatile uint32_t Dropped;
+
+// Returns 0 (and counts the event as dropped) if the queue is full.
+uint32_t QueuePut(const uint8_t id,
+                  const uint32_t time)
+{
+    uint32_t head = QueueHead;
+    uint32_t used = head - QueueTail;
+
+    if (used >= EVENT_QUEUE_SZ)
+    {
+        Dropped++;
+        return 0;
+    }
+
+    EventQueue[head & EVENT_QUEUE_MASK] = (time << EVENT_ID_BITS) | id;
+    __DMB();                    // the event must be complete before the consumer can see it
+    QueueHead = head + 1;
+
+    if (used + 1 > HighWater)
+        HighWater = used + 1;
+
+    return 1;
+}
+
+// Returns 0 if the queue is empty.
+uint32_t QueueGet(event_t * const event)
+{
+    uint32_t tail = QueueTail;
+    uint32_t slot;
+    uint32_t now;
+
+    if (tail == QueueHead)
+        return 0;
+
+    slot = EventQueue[tail & EVENT_QUEUE_MASK];
+    __DMB();                    // finish reading the slot before handing it back to the producer
+    QueueTail = tail + 1;
+
+    // The age in ms is the difference of the 24 bit times, modulo 2^24
+    now = TimerNow();
+    event->id   = (uint8_t)(slot & EVENT_ID_MASK);
+    event->time = now - (((now << EVENT_ID_BITS) - (slot & ~EVENT_ID_MASK)) >> EVENT_ID_BITS);
+
+    return 1;
+}
+
+uint32_t QueueEmpty(void)
+{
+    return QueueTail == QueueHead;
+}
+
+uint32_t QueueHighWater(void)
+{
+    return HighWater;
+}
+
+uint32_t QueueDropped(void)
+{
+    return Dropped;
+}
@@ -0,0 +1,25 @@
+#ifndef QUEUERTNS_H
+#define QUEUERTNS_H
+
+#include "stdint.h"
+
+// Event queue between the interrupt handlers (producer) and the main loop (consumer).
+// The size must be a power of two.
+#define EVENT_QUEUE_SZ          32
+
+// As returned by QueueGet(). A queue slot is one word: the low 24 bits of the time above the id, so the time
+// is only right for an event that has been queued for less than 2^24 ms (4.6 hours).
+typedef struct
+{
+    uint32_t time;              // TimerNow() when the event was queued; never in the future
+    uint8_t  id;                // e.g. which switch was pressed
+} event_t;
+
+uint32_t QueuePut               (const uint8_t id,
+                                 const uint32_t time);
+uint32_t QueueGet               (event_t * const event);
+uint32_t QueueEmpty             (void);
+uint32_t QueueHighWater         (void);
+uint32_t QueueDropped           (void);
+
+#endif // QUEUERTNS_H
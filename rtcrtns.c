@@ -0,0 +1,117 @@
+// Wall clock on the Hibernation module RTC; see 7.3.3 Real-Time Clock and 7.4.2 RTC Match Functionality.
+//
+// The RTC counts seconds (HIBRTCC) from the 32.768kHz crystal on XOSC0/XOSC1, so the time of day does not drift
+// with the system clock or with how late the main loop gets round to it. The match interrupt (RTCALT0) is armed
+// for the next minute boundary; RtcHandler() queues RTC_MINUTE and arms the one after. There is no periodic
+// interrupt for timekeeping.
+//
+// The Hibernation module is powered from VBAT (tied to 3.3V on the LaunchPad; fit a battery to keep the time
+// through a main power loss). Its registers keep their contents across a reset, so RtcInit() leaves a running
+// RTC alone; HIBDATA holds RTC_VALID once the time has been set.
+//
+// Every write to a Hibernation register takes up to three 32.768kHz cycles; WRC must be set before the next
+// write (see 7.3.1 Register Access Timing).
+
+#include "TM4C123GH6PM.h"
+
+#include "queuertns.h"
+#include "rtcrtns.h"
+#include "timerrtns.h"
+
+#define HIB_CTL_RTCEN           (1U << 0)
+#define HIB_CTL_CLK32EN         (1U << 6)
+#define HIB_CTL_WRC             (1U << 31)
+
+#define HIB_INT_RTCALT0         (1U << 0)       // HIBIM/HIBRIS/HIBIC: RTC match 0
+
+#define RTC_VALID               0x52544331      // "RTC1"
+
+static void waitWrite(void);
+static void armMinute(void);
+
+// Returns 1 if the RTC has kept the time since it was last set, 0 if RtcSet() must be called
+uint32_t RtcInit(void)
+{
+    uint32_t running;
+
+    // Enable the clock to the Hibernation module (RCGCHIB) and wait for PRHIB; see UartEnable().
+    SYSCTL->RCGCHIB |= (1 << 0);
+    while ((SYSCTL->PRHIB & (1 << 0)) == 0);
+
+    running = (HIB->CTL & (HIB_CTL_CLK32EN | HIB_CTL_RTCEN)) == (HIB_CTL_CLK32EN | HIB_CTL_RTCEN) &&
+              HIB->DATA == RTC_VALID;
+
+    if (!running)
+    {
+        // See 7.4.1 Initialization: start the oscillator, then the RTC. The RTC counts once the crystal has
+        // settled.
+        waitWrite();
+        HIB->CTL = HIB_CTL_CLK32EN;
+        waitWrite();
+        HIB->RTCLD = 0;
+        waitWrite();
+        HIB->CTL = HIB_CTL_CLK32EN | HIB_CTL_RTCEN;
+    }
+
+    armMinute();
+    waitWrite();
+    HIB->IM = HIB_INT_RTCALT0;
+
+    // The Hibernation module is interrupt number 43 (see startup_TM4C123.s; look for HIB_Handler)
+    // m = 43 / 32 = 1; hence we update ISER[1]; b = 43 % 32 = 11; hence we set bit 11.
+    NVIC->IP[43] = 3 << 5;      // Same priority as GPIOF: RtcHandler() queues events
+    NVIC->ISER[1] = (1 << 11);
+
+    return running;
+}
+
+// Set the time of day in seconds since midnight
+void RtcSet(const uint32_t seconds)
+{
+    waitWrite();
+    HIB->RTCLD = seconds % RTC_DAY_SECONDS;     // loads HIBRTCC
+    waitWrite();
+    HIB->DATA = RTC_VALID;
+    armMinute();
+}
+
+// Seconds since midnight
+uint32_t RtcSeconds(void)
+{
+    return HIB->RTCC % RTC_DAY_SECONDS;
+}
+
+// The RTC counter: seconds, counting on past midnight; it only jumps when RtcSet() is called
+uint32_t RtcCounter(void)
+{
+    return HIB->RTCC;
+}
+
+// Called from HIB_Handler at a minute boundary
+void RtcHandler(void)
+{
+    waitWrite();
+    HIB->IC = HIB_INT_RTCALT0;
+    armMinute();
+    QueuePut(RTC_MINUTE, TimerNow());
+}
+
+static void waitWrite(void)
+{
+    while ((HIB->CTL & HIB_CTL_WRC) == 0);
+}
+
+// Match at the start of the next minute. If the counter got there while the match was written, the interrupt
+// is pended by hand rather than a minute being lost.
+static void armMinute(void)
+{
+    uint32_t now = HIB->RTCC;
+    uint32_t next = now - now % 60 + 60;
+
+    waitWrite();
+    HIB->RTCM0 = next;
+    waitWrite();
+
+    if ((int32_t)(HIB->RTCC - next) >= 0)
+        NVIC->ISPR[1] = (1 << 11);
+}
@@ -0,0 +1,17 @@
+#ifndef RTCRTNS_H
+#define RTCRTNS_H
+
+#include "stdint.h"
+
+// Event id queued by RtcHandler() at every minute boundary; follows the input event ids (see inputrtns.h)
+#define RTC_MINUTE              4
+
+#define RTC_DAY_SECONDS         (24 * 60 * 60)
+
+uint32_t RtcInit                (void);
+void RtcSet                     (const uint32_t seconds);
+uint32_t RtcSeconds             (void);
+uint32_t RtcCounter             (void);
+void RtcHandler                 (void);
+
+#endif // RTCRTNS_H
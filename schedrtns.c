@@ -0,0 +1,53 @@
+// Ready set of a cooperative run-to-completion scheduler, kept as one word with bit 31 - n for task n.
+//
+// The interrupt handlers post the task that consumes what they have produced; the main loop takes the highest
+// priority ready task with SchedNext() and runs it to completion, then takes the next. CLZ finds that task in
+// one instruction however many are ready (see the ARMv7-M Architecture Reference Manual, A7.7.24), so the cost
+// of choosing does not grow with the number of tasks. A posting is a read-modify-write of the ready word from
+// any priority, so it takes PRIMASK for the three instructions it needs, as TraceRecord() does.
+//
+// A task posted while it is ready runs once: posting is idempotent, so a task must consume everything it was
+// posted for, or post itself again for the rest.
+
+#include "TM4C123GH6PM.h"
+
+#include "schedrtns.h"
+
+#define SCHED_BIT(task)         (0x80000000U >> (task))
+
+static volatile uint32_t Ready;
+
+// Call from any priority
+void SchedPost(const uint32_t task)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Ready |= SCHED_BIT(task);
+    __set_PRIMASK(primask);
+}
+
+// Takes the highest priority ready task off the ready set; returns SCHED_NONE if there is none.
+uint32_t SchedNext(void)
+{
+    uint32_t primask;
+    uint32_t task;
+
+    if (Ready == 0)
+        return SCHED_NONE;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    task = __CLZ(Ready);
+    Ready &= ~SCHED_BIT(task);
+    __set_PRIMASK(primask);
+
+    return task;
+}
+
+// Non zero if any task is ready. Call with interrupts disabled before sleeping, so that a posting cannot slip
+// in between the check and the WFI.
+uint32_t SchedReady(void)
+{
+    return Ready;
+}
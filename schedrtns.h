@@ -0,0 +1,15 @@
+#ifndef SCHEDRTNS_H
+#define SCHEDRTNS_H
+
+#include "stdint.h"
+
+// Cooperative run-to-completion scheduler: tasks are numbered by priority, 0 the highest, and are made ready
+// by SchedPost() from the interrupt handlers or from other tasks (see schedrtns.c).
+#define SCHED_TASK_COUNT        32      // one bit of the ready word each
+#define SCHED_NONE              SCHED_TASK_COUNT
+
+void SchedPost                  (const uint32_t task);
+uint32_t SchedNext              (void);
+uint32_t SchedReady             (void);
+
+#endif // SCHEDRTNS_H
@@ -0,0 +1,120 @@
+// The time display on the UART0 terminal.
+//
+// The last frame sent is cached together with the column the terminal cursor was left at. A new frame only
+// sends the characters that changed: the cursor is moved back with backspaces (or a carriage return, if that
+// is shorter) and forward by retyping the unchanged characters, which is never longer than an ANSI cursor
+// movement for a five character frame. An identical frame sends nothing. Rolling over to the next minute
+// sends two bytes ("\b" and the digit) instead of six.
+//
+// Anything else written to the terminal moves the cursor; call ScreenInvalidate() afterwards so that the next
+// frame is sent in full.
+
+#include "benchrtns.h"
+#include "fmtrtns.h"
+#include "screenrtns.h"
+#include "uartrtns.h"
+
+#if SCREEN_WIDTH != FMT_TIME_SZ - 2
+#error "SCREEN_WIDTH must match the FmtTime() frame"
+#endif
+
+#define SCREEN_UNKNOWN          0xFF    // Cursor: the terminal does not show the cached frame
+
+// Moving back to the first change costs at most SCREEN_WIDTH characters, writing from there to the last
+// change at most SCREEN_WIDTH more; a full frame is "\r" plus SCREEN_WIDTH characters.
+#define SCREEN_OUTPUT_SZ        (2 * SCREEN_WIDTH + 1 + 1)
+
+static char Shown[SCREEN_WIDTH];
+static uint32_t Cursor;
+
+static void showFrame(const char * const frame);
+
+void ScreenInit(void)
+{
+    ScreenInvalidate();
+}
+
+void ScreenInvalidate(void)
+{
+    Cursor = SCREEN_UNKNOWN;
+}
+
+// Show hh:mm, sending only what differs from the frame on the terminal
+void ScreenTime(const uint32_t hh,
+                const uint32_t mm)
+{
+    char frame[FMT_TIME_SZ];
+
+    FmtTime(frame, hh, mm);
+    showFrame(frame);
+}
+
+// Show mm:ss the same way; the last seconds of a countdown change one or two characters a second
+void ScreenCountdown(const uint32_t mm,
+                     const uint32_t ss)
+{
+    char frame[FMT_TIME_SZ];
+
+    FmtCountdown(frame, mm, ss);
+    showFrame(frame);
+}
+
+static void showFrame(const char * const frame)
+{
+    char output[SCREEN_OUTPUT_SZ];
+    uint32_t length = 0;
+    uint32_t i;
+
+    if (Cursor == SCREEN_UNKNOWN)
+    {
+        output[length++] = '\r';
+        for (i = 0; i < SCREEN_WIDTH; i++)
+            output[length++] = frame[i];
+        Cursor = SCREEN_WIDTH;
+    }
+    else
+    {
+        for (i = 0; i < SCREEN_WIDTH; i++)
+        {
+            if (frame[i] == Shown[i])
+                continue;
+
+            // Changes are written left to right, so only the first one can be behind the cursor
+            if (i < Cursor)
+            {
+                if (Cursor - i <= i + 1)
+                {
+                    while (Cursor > i)
+                    {
+                        output[length++] = '\b';
+                        Cursor--;
+                    }
+                }
+                else
+                {
+                    output[length++] = '\r';
+                    Cursor = 0;
+                }
+            }
+
+            // Columns between the cursor and this change are either unchanged or already written
+            while (Cursor < i)
+                output[length++] = frame[Cursor++];
+
+            output[length++] = frame[i];
+            Cursor = i + 1;
+        }
+    }
+
+    for (i = 0; i < SCREEN_WIDTH; i++)
+        Shown[i] = frame[i];
+
+    if (length == 0)
+        return;
+
+    output[length] = '\0';
+#ifdef BENCHMARK
+    BenchFrameQueued();
+#endif
+    UartTxWrite(UART_0, output);
+}
@@ -0,0 +1,16 @@
+#ifndef SCREENRTNS_H
+#define SCREENRTNS_H
+
+#include "stdint.h"
+
+// The "hh:mm" frame shown on the UART0 terminal
+#define SCREEN_WIDTH            5
+
+void ScreenInit                 (void);
+void ScreenInvalidate           (void);
+void ScreenTime                 (const uint32_t hh,
+                                 const uint32_t mm);
+void ScreenCountdown            (const uint32_t mm,
+                                 const uint32_t ss);
+
+#endif // SCREENRTNS_H
@@ -0,0 +1,211 @@
+// Host simulation substitute for Keil's TM4C123GH6PM.h and core_cm4.h (see simrtns.c).
+//
+// The register blocks are plain memory. The blocks with live or read-only state (SYSCTL, GPIO Port F,
+// Wide Timer 0 and the Hibernation module) are reached through an accessor that brings them up to date with
+// the virtual time before every access, so the firmware's polling loops and counters behave as on the device.
+// The EEPROM goes through an accessor too, which reads and writes the word EEBLOCK and EEOFFSET select.
+// The UART blocks stay at fixed addresses, as uartrtns.c keeps them in a const table; instead every UARTDR
+// access goes through SimUartDr(), which moves the FIFOs and brings UARTFR, UARTRIS and UARTMIS up to date.
+// Only the registers and intrinsics used by the firmware are modelled. The field names are those of the device
+// header; the layouts are not the device's.
+
+#ifndef TM4C123GH6PM_H
+#define TM4C123GH6PM_H
+
+#include <stdint.h>
+
+#define __I                     volatile const
+#define __O                     volatile
+#define __IO                    volatile
+
+typedef struct
+{
+    __IO uint32_t DID0, DID1, DC0, RESERVED0, DC1, DC2, DC3, DC4, DC5, DC6, DC7, DC8, PBORCTL, RESERVED1[3],
+                  SRCR0, SRCR1, SRCR2, RESERVED2, RIS, IMC, MISC, RESC, RCC, RESERVED3[2], GPIOHBCTL, RCC2,
+                  RESERVED4[2], MOSCCTL, RESERVED5[49], DSLPCLKCFG, RESERVED6, SYSPROP, PIOSCCAL, PIOSCSTAT,
+                  RESERVED7[2], PLLFREQ0, PLLFREQ1, PLLSTAT, ALTCLKCFG, SLPPWRCFG, DSLPPWRCFG;
+    __IO uint32_t SRGPIO, SRUART, SREEPROM, RCGCWD, RCGCTIMER, RCGCGPIO, RCGCDMA, RCGCHIB, RCGCUART, RCGCSSI,
+                  RCGCI2C, RCGCUSB, RCGCCAN, RCGCADC, RCGCACMP, RCGCPWM, RCGCQEI, RCGCEEPROM, RCGCWTIMER;
+    __IO uint32_t SCGCWD, SCGCTIMER, SCGCGPIO, SCGCDMA, SCGCHIB, SCGCUART, SCGCPWM, SCGCEEPROM, SCGCWTIMER;
+    __IO uint32_t DCGCWD, DCGCTIMER, DCGCGPIO, DCGCDMA, DCGCHIB, DCGCUART, DCGCPWM, DCGCEEPROM, DCGCWTIMER;
+    __IO uint32_t PRWD, PRTIMER, PRGPIO, PRDMA, PRHIB, PRUART, PRSSI, PRI2C, PRUSB, PRCAN, PRADC, PRACMP, PRPWM,
+                  PRQEI, PREEPROM, PRWTIMER;
+} SYSCTL_Type;
+
+typedef struct
+{
+    __IO uint32_t DATA_BITS[255];
+    __IO uint32_t DATA, DIR, IS, IBE, IEV, IM, RIS, MIS, ICR, AFSEL, RESERVED1[55], DR2R, DR4R, DR8R, ODR, PUR,
+                  PDR, SLR, DEN, LOCK, CR, AMSEL, PCTL, ADCCTL, DMACTL;
+} GPIOA_Type;
+
+typedef struct
+{
+    __IO uint32_t DR_BITS[1], RSR, RESERVED0[4], FR, RESERVED1, ILPR, IBRD, FBRD, LCRH, CTL, IFLS, IM, RIS, MIS, ICR,
+                  DMACTL, RESERVED2[22], _9BITADDR, _9BITAMASK, RESERVED3[965], PP, RESERVED4, CC;
+} UART0_Type;
+
+typedef struct
+{
+    __IO uint32_t CFG, TAMR, TBMR, CTL, SYNC, RESERVED0, IMR, RIS, MIS, ICR, TAILR, TBILR, TAMATCHR, TBMATCHR,
+                  TAPR, TBPR, TAPMR, TBPMR, TAR, TBR, TAV, TBV, RTCPD, TAPS, TBPS, TAPV, TBPV, RESERVED1[981],
+                  PP, RESERVED2, CC;
+} TIMER0_Type;
+
+typedef TIMER0_Type WTIMER0_Type;
+
+typedef struct
+{
+    __IO uint32_t STAT, CFG, CTLBASE, ALTBASE, WAITSTAT, SWREQ, USEBURSTSET, USEBURSTCLR, REQMASKSET,
+                  REQMASKCLR, ENASET, ENACLR, ALTSET, ALTCLR, PRIOSET, PRIOCLR, RESERVED0[3], ERRCLR,
+                  RESERVED1[300], CHASGN, CHIS, RESERVED2[2], CHMAP0, CHMAP1, CHMAP2, CHMAP3;
+} UDMA_Type;
+
+typedef struct
+{
+    __IO uint32_t RTCC, RTCM0, RESERVED0, RTCLD, CTL, IM, RIS, MIS, IC, RTCT, RTCSS, RESERVED1, DATA;
+} HIB_Type;
+
+typedef struct
+{
+    __IO uint32_t EESIZE, EEBLOCK, EEOFFSET, RESERVED0, EERDWR, EERDWRINC, EEDONE, EESUPP, EEUNLOCK,
+                  RESERVED1[3], EEPROT, EEPASS0, EEPASS1, EEPASS2, EEINT, RESERVED2[3], EEHIDE, RESERVED3[11],
+                  EEDBGME, RESERVED4[975], PP;
+} EEPROM_Type;
+
+typedef struct
+{
+    __IO uint32_t CTL, SYNC, ENABLE, INVERT, FAULT, INTEN, RIS, ISC, STATUS, FAULTVAL, ENUPD, RESERVED0[5];
+    __IO uint32_t _0_CTL, _0_INTEN, _0_RIS, _0_ISC, _0_LOAD, _0_COUNT, _0_CMPA, _0_CMPB, _0_GENA, _0_GENB,
+                  _0_DBCTL, _0_DBRISE, _0_DBFALL, _0_FLTSRC0, _0_FLTSRC1, _0_MINFLTPER;
+    __IO uint32_t _1_CTL, _1_INTEN, _1_RIS, _1_ISC, _1_LOAD, _1_COUNT, _1_CMPA, _1_CMPB, _1_GENA, _1_GENB,
+                  _1_DBCTL, _1_DBRISE, _1_DBFALL, _1_FLTSRC0, _1_FLTSRC1, _1_MINFLTPER;
+    __IO uint32_t _2_CTL, _2_INTEN, _2_RIS, _2_ISC, _2_LOAD, _2_COUNT, _2_CMPA, _2_CMPB, _2_GENA, _2_GENB,
+                  _2_DBCTL, _2_DBRISE, _2_DBFALL, _2_FLTSRC0, _2_FLTSRC1, _2_MINFLTPER;
+    __IO uint32_t _3_CTL, _3_INTEN, _3_RIS, _3_ISC, _3_LOAD, _3_COUNT, _3_CMPA, _3_CMPB, _3_GENA, _3_GENB,
+                  _3_DBCTL, _3_DBRISE, _3_DBFALL, _3_FLTSRC0, _3_FLTSRC1, _3_MINFLTPER;
+    __IO uint32_t PP;
+} PWM0_Type;
+
+typedef struct
+{
+    __IO uint32_t CTRL, LOAD, VAL;
+    __I uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    __IO uint32_t ISER[8];
+    uint32_t R0[24];
+    __IO uint32_t ICER[8];
+    uint32_t R1[24];
+    __IO uint32_t ISPR[8];
+    uint32_t R2[24];
+    __IO uint32_t ICPR[8];
+    uint32_t R3[24];
+    __IO uint32_t IABR[8];
+    uint32_t R4[56];
+    __IO uint8_t IP[240];
+    uint32_t R5[644];
+    __O uint32_t STIR;
+} NVIC_Type;
+
+typedef struct
+{
+    __I uint32_t CPUID;
+    __IO uint32_t ICSR, VTOR, AIRCR, SCR, CCR;
+    __IO uint8_t SHP[12];
+    __IO uint32_t SHCSR, CFSR, HFSR, DFSR, MMFAR, BFAR, AFSR;
+} SCB_Type;
+
+typedef struct
+{
+    __IO uint32_t CTRL, CYCCNT, CPICNT, EXCCNT, SLEEPCNT, LSUCNT, FOLDCNT, PCSR;
+} DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    __O union { __O uint8_t u8; __O uint16_t u16; __O uint32_t u32; } PORT[32];
+    uint32_t R0[864];
+    __IO uint32_t TER;
+    uint32_t R1[15];
+    __IO uint32_t TPR;
+    uint32_t R2[15];
+    __IO uint32_t TCR;
+    uint32_t R3[29];
+    __O uint32_t IWR;
+    __I uint32_t IRR;
+    __IO uint32_t IMCR;
+    uint32_t R4[43];
+    __O uint32_t LAR;
+    __I uint32_t LSR;
+} ITM_Type;
+
+typedef struct
+{
+    __IO uint32_t SSPSR, CSPSR;
+    uint32_t R0[2];
+    __IO uint32_t ACPR;
+    uint32_t R1[55];
+    __IO uint32_t SPPR;
+} TPI_Type;
+
+#include "simrtns.h"
+
+#define SYSCTL                  (SimSysctl())
+#define GPIOA                   (&SimGpio[0])
+#define GPIOB                   (&SimGpio[1])
+#define GPIOC                   (&SimGpio[2])
+#define GPIOD                   (&SimGpio[3])
+#define GPIOE                   (&SimGpio[4])
+#define GPIOF                   (SimGpioF())
+#define GPIOA_AHB               GPIOA
+#define GPIOB_AHB               GPIOB
+#define GPIOC_AHB               GPIOC
+#define GPIOD_AHB               GPIOD
+#define GPIOE_AHB               GPIOE
+#define GPIOF_AHB               GPIOF
+#define UART0                   (&SimUart[0])
+#define UART1                   (&SimUart[1])
+#define UART2                   (&SimUart[2])
+#define UART3                   (&SimUart[3])
+#define UART4                   (&SimUart[4])
+#define UART5                   (&SimUart[5])
+#define UART6                   (&SimUart[6])
+#define UART7                   (&SimUart[7])
+#define DR                      DR_BITS[SimUartDr()]
+#define WTIMER0                 (SimWtimer0())
+#define UDMA                    (&SimUdma)
+#define HIB                     (SimHib())
+#define EEPROM                  (SimEeprom())
+#define PWM0                    (&SimPwm[0])
+#define PWM1                    (&SimPwm[1])
+#define SysTick                 (&SimSysTick)
+#define NVIC                    (&SimNvic)
+#define SCB                     (&SimScb)
+#define DWT                     (&SimDwt)
+#define CoreDebug               (&SimCoreDebug)
+#define ITM                     (&SimItm)
+#define TPI                     (&SimTpi)
+
+// No preemption: the handlers run from __WFI(), i.e. only while the main loop sleeps
+#define __disable_irq()         ((void)0)
+#define __enable_irq()          ((void)0)
+#define __get_PRIMASK()         0U
+#define __set_PRIMASK(primask)  ((void)(primask))
+#define __DMB()                 ((void)0)
+#define __DSB()                 ((void)0)
+#define __ISB()                 ((void)0)
+#define __NOP()                 ((void)0)
+#define __WFI()                 SimIdle()
+#define __CLZ(value)            ((value) != 0 ? (uint32_t)__builtin_clz(value) : 32U)
+
+// The firmware runs on the host's stack; MSP is the top of the stand-in STACK section (see simrtns.c)
+#define __get_MSP()             SimMsp()
+
+#endif // TM4C123GH6PM_H
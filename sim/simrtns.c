@@ -0,0 +1,767 @@
+// Host simulation: the firmware built for a PC, with a simulated GPIO Port F, UART0 and millisecond tick, run
+// in virtual time.
+//
+// Everything above the registers is the firmware as it is: the input debounce and auto-repeat, the event
+// queue, the software timers, the RTC minute, the state machine, the protocol parser and the display. This file
+// replaces the hardware underneath:
+// - TM4C123GH6PM.h in this directory stands in for the device header. The register blocks are plain memory;
+//   SYSCTL, GPIO Port F, Wide Timer 0 and the Hibernation module go through the accessors below, which update
+//   the counters and the read-only bits from the virtual time and apply the write-1-to-clear registers.
+// - UART0 is modelled at its registers, so uartrtns.c runs as it does on the board. Every UARTDR access goes
+//   through SimUartDr(): there are 16 character FIFOs each way, a character takes SIM_UART_CHAR_TIME to send
+//   or receive, UARTFR, UARTRIS and UARTMIS follow the FIFOs and UARTIFLS, and UARTICR is write 1 to clear.
+//   The transmit side goes to stdout and the receive side is fed from the trace. The handlers never preempt
+//   the main loop (see below), so UART_TX_BLOCK would wait forever; the firmware uses UART_TX_DROP_NEWEST.
+// - The STACK section of startup_TM4C123.s is a block of SIM_STACK_SZ bytes with the symbols armlink would give
+//   it, STACK$$Base and STACK$$Limit, and __get_MSP() is its top. The firmware really runs on the host's stack,
+//   so with MEMORY_REPORT the stack row of 'm' reads 0; the queue and UART0 rows are the firmware's own.
+// - __WFI() is SimIdle(). Virtual time only moves while the main loop sleeps, and then straight to the next
+//   thing that can wake it: a trace event, the Wide Timer 0A match (software timers), the Wide Timer 0B one shot
+//   (debounce and repeat), the RTC minute match or a UART0 character. A sixty minute countdown takes milliseconds. The interrupt
+//   handlers are called from SimIdle(), i.e. they never preempt the main loop; TICKLESS must be defined.
+//   The CPU is taken to be infinitely fast, except that a main loop that keeps reading the timer without
+//   sleeping (e.g. for a software timer due on the next tick) moves the time on by a millisecond every
+//   SIM_SPIN_READS reads.
+//
+// Build from the top directory with the host compiler, e.g.
+//   cc -std=c99 -O2 -Isim -I. -o alarm-sim main.c alarmrtns.c benchrtns.c clockrtns.c diagrtns.c eepromrtns.c
+//      fmtrtns.c gpiortns.c inputrtns.c ledrtns.c memrtns.c periphrtns.c profrtns.c protortns.c queuertns.c
+//      rtcrtns.c schedrtns.c screenrtns.c statertns.c timerrtns.c tracertns.c uartrtns.c sim/simrtns.c
+// and run with a trace on stdin: ./alarm-sim < sim/alarm.trace
+//
+// A trace has one event per line, at a time in milliseconds since reset; times must not go backwards and
+// '#' starts a comment:
+//   <ms> press <1|2>           switch 1 or 2 goes down (one edge; list the bounces as separate lines)
+//   <ms> release <1|2>
+//   <ms> key <c>               character received on UART0
+//   <ms> send <xx> <xx> ...    bytes received on UART0, in hex (a protocol frame; see protortns.h)
+//   <ms> end                   stop the simulation
+// The simulation also stops at the end of the trace. UART0 output goes to stdout, so two runs can be compared
+// byte for byte; the virtual time, the number of interrupts and the host CPU time per interrupt go to stderr.
+// What the firmware has queued for UART0 when the simulation stops is sent before it exits.
+//
+// With SIM_STATE set to a file name the battery backed state (the RTC and HIBDATA) and the EEPROM are loaded
+// from the file at reset and saved to it at the end, so that a second run starts as the board does after a
+// reset. SIM_OFF adds that many seconds of power off to the RTC in between.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "TM4C123GH6PM.h"
+
+#include "eepromrtns.h"
+#include "inputrtns.h"
+
+void GPIOF_Handler(void);
+void WTIMER0A_Handler(void);
+void WTIMER0B_Handler(void);
+void HIB_Handler(void);
+void UART0_Handler(void);
+
+// Size of the stand-in STACK section, as Stack_Size in startup_TM4C123.s
+#define SIM_STACK_SZ            1024
+
+// SYSCTL RIS
+#define RIS_PLLLRIS             (1U << 6)
+#define RIS_MOSCPUPRIS          (1U << 8)
+
+// GPTM
+#define GPTM_INT_TAM            (1U << 4)
+#define GPTM_INT_TBTO           (1U << 8)
+#define GPTM_CTL_TBEN           (1U << 8)
+
+// Hibernation module
+#define HIB_CTL_RTCEN           (1U << 0)
+#define HIB_CTL_WRC             (1U << 31)
+#define HIB_INT_RTCALT0         (1U << 0)
+#define HIB_RTCLD_NONE          0xFFFFFFFF      // nothing written to HIBRTCLD since the last access
+
+// UART
+#define UART_FR_RXFE            (1U << 4)
+#define UART_FR_TXFF            (1U << 5)
+#define UART_FR_RXFF            (1U << 6)
+#define UART_FR_TXFE            (1U << 7)
+#define UART_INT_RX             (1U << 4)
+#define UART_INT_TX             (1U << 5)
+#define UART_INT_RT             (1U << 6)
+#define UART_INT_OE             (1U << 10)
+#define UART_FIFO_SZ            16
+#define UART_DR_SHOWN           (1U << 16)      // set in the UARTDR word SimUartDr() leaves, never in a store
+
+#define SIM_UART_CHAR_TIME      1               // ms per character: 10 bits at 9600 baud, near enough
+#define SIM_UART_RT_TIME        4               // receive time-out: 32 bit periods, rounded up
+#define SIM_UART_LINE_SZ        1024            // trace bytes not yet received
+
+// Interrupt numbers
+#define IRQ_UART0               5
+#define IRQ_GPIOF               30
+#define IRQ_HIB                 43
+#define IRQ_WTIMER0A            94
+#define IRQ_WTIMER0B            95
+
+#define SWITCH_PINS             ((1U << SWITCH_1_PIN) | (1U << SWITCH_2_PIN))
+
+#define TRACE_LINE_SZ           256
+
+#define SIM_SPIN_READS          100
+
+typedef enum
+{
+    TRACE_NONE = 0,
+    TRACE_PRESS,
+    TRACE_RELEASE,
+    TRACE_RECEIVE,
+    TRACE_END
+} trace_type_t;
+
+typedef struct
+{
+    trace_type_t type;
+    uint32_t     time;
+    uint32_t     pins;                          // TRACE_PRESS, TRACE_RELEASE
+    uint8_t      bytes[TRACE_LINE_SZ / 2];      // TRACE_RECEIVE
+    uint32_t     count;
+} trace_event_t;
+
+GPIOA_Type SimGpio[5];
+UART0_Type SimUart[8];
+UDMA_Type SimUdma;
+PWM0_Type SimPwm[2];
+SysTick_Type SimSysTick;
+NVIC_Type SimNvic;
+SCB_Type SimScb;
+DWT_Type SimDwt;
+CoreDebug_Type SimCoreDebug;
+ITM_Type SimItm;
+TPI_Type SimTpi;
+
+// The STACK section; the names need quoting for the assembler
+#define SIM_STRING(x)           #x
+#define SIM_SPACE(size)         ".space " SIM_STRING(size) "\n"
+__asm__(".pushsection .bss\n"
+        ".balign 8\n"
+        ".globl \"STACK$$Base\"\n"
+        "\"STACK$$Base\":\n"
+        SIM_SPACE(SIM_STACK_SZ)
+        ".globl \"STACK$$Limit\"\n"
+        "\"STACK$$Limit\":\n"
+        ".popsection\n");
+
+extern uint32_t STACK$$Limit;
+
+static SYSCTL_Type Sysctl;
+static GPIOA_Type GpioF;
+static WTIMER0_Type Wtimer0;
+static HIB_Type Hib;
+static EEPROM_Type Eeprom;
+
+// Milliseconds since reset
+static uint32_t Now;
+
+// Wide Timer 0 accesses since the main loop last slept
+static uint32_t Spin;
+
+// Switch pins as the pads read them; a switch pulls its pin low when pressed
+static uint32_t Levels = SWITCH_PINS;
+
+// Wide Timer 0B one shot
+static uint32_t OneShotArmed;
+static uint32_t OneShotDeadline;
+
+// HIBRTCC = RtcBase + seconds since RtcLoaded
+static uint32_t RtcBase;
+static uint32_t RtcLoaded;
+
+// EEPROM contents, and the word EERDWR held after the last access
+static uint32_t EepromWords[EEPROM_BLOCKS * EEPROM_BLOCK_WORDS];
+static uint32_t EepromShown;
+
+// Saved by finish() for the next run (see SIM_STATE)
+typedef struct
+{
+    uint32_t rtcc;
+    uint32_t ctl;
+    uint32_t data;
+    uint32_t eeprom[EEPROM_BLOCKS * EEPROM_BLOCK_WORDS];
+} sim_state_t;
+
+static trace_event_t Next;
+static uint32_t TraceLine;
+
+// Statistics
+static uint32_t Interrupts;
+static uint32_t TraceEvents;
+
+// UART0 FIFOs (free running indices), the end of the character being sent and the time the last character
+// was received. UARTIFLS levels: 1/8, 1/4, 1/2, 3/4 and 7/8 of the FIFO.
+static const uint32_t UartLevels[8] = { 2, 4, 8, 12, 14, 14, 14, 14 };
+static uint8_t UartRx[UART_FIFO_SZ];
+static uint32_t UartRxHead;
+static uint32_t UartRxTail;
+static uint32_t UartRxLast;
+static uint32_t UartRtArmed;
+static uint8_t UartTx[UART_FIFO_SZ];
+static uint32_t UartTxHead;
+static uint32_t UartTxTail;
+static uint32_t UartTxDone;
+
+// The UARTDR access SimUartDr() last prepared for, whether it took a character from the receive FIFO and the
+// character it left in UART0's UARTDR
+static uint32_t UartAccess;
+static uint32_t UartPopped;
+static uint32_t UartShown;
+
+// Trace bytes still on the line; the next one is in the receive FIFO at UartLineNext
+static uint8_t UartLine[SIM_UART_LINE_SZ];
+static uint32_t UartLineHead;
+static uint32_t UartLineTail;
+static uint32_t UartLineNext;
+
+static void start(void);
+static uint32_t serviceDue(void);
+static uint32_t nextWake(uint32_t * const wake);
+static void interrupt(const uint32_t irq);
+static void updateUart(void);
+static void setUartFlags(const uint32_t write);
+static void applyTrace(const trace_event_t * const event);
+static void setLevels(const uint32_t levels);
+static void readTrace(void);
+static void finish(void);
+
+SYSCTL_Type * SimSysctl(void)
+{
+    start();
+
+    // Every module is ready as soon as it is clocked; the PLL locks at once
+    Sysctl.PRWD = Sysctl.PRTIMER = Sysctl.PRGPIO = Sysctl.PRDMA = Sysctl.PRHIB = Sysctl.PRUART = 0xFFFFFFFF;
+    Sysctl.PRSSI = Sysctl.PRI2C = Sysctl.PRUSB = Sysctl.PRCAN = Sysctl.PRADC = Sysctl.PRACMP = 0xFFFFFFFF;
+    Sysctl.PRPWM = Sysctl.PRQEI = Sysctl.PREEPROM = Sysctl.PRWTIMER = 0xFFFFFFFF;
+    Sysctl.RIS |= RIS_PLLLRIS | RIS_MOSCPUPRIS;
+    return &Sysctl;
+}
+
+// GPIOICR is write 1 to clear: apply the last write, then derive GPIOMIS
+GPIOA_Type * SimGpioF(void)
+{
+    GpioF.RIS &= ~GpioF.ICR;
+    GpioF.ICR = 0;
+    GpioF.MIS = GpioF.RIS & GpioF.IM;
+    return &GpioF;
+}
+
+// Timer A counts down from 0xFFFFFFFF once a millisecond (see timerrtns.c). Timer B is armed when TBEN is set.
+WTIMER0_Type * SimWtimer0(void)
+{
+    if (++Spin == SIM_SPIN_READS)
+    {
+        Spin = 0;
+        Now++;
+    }
+
+    Wtimer0.TAR = Wtimer0.TAV = 0xFFFFFFFF - Now;
+
+    if ((Wtimer0.CTL & GPTM_CTL_TBEN) == 0)
+    {
+        OneShotArmed = 0;
+    }
+    else if (!OneShotArmed)
+    {
+        OneShotArmed    = 1;
+        OneShotDeadline = Now + Wtimer0.TBILR;
+    }
+    return &Wtimer0;
+}
+
+// HIBRTCLD loads the counter; HIBCTL WRC always reads set (a write completes at once)
+HIB_Type * SimHib(void)
+{
+    start();
+
+    if (Hib.RTCLD != HIB_RTCLD_NONE)
+    {
+        RtcBase   = Hib.RTCLD;
+        RtcLoaded = Now;
+        Hib.RTCLD = HIB_RTCLD_NONE;
+    }
+    if (Hib.CTL & HIB_CTL_RTCEN)
+        Hib.RTCC = RtcBase + (Now - RtcLoaded) / 1000;
+    Hib.CTL |= HIB_CTL_WRC;
+    return &Hib;
+}
+
+// A write to EERDWR shows as a change of the word the last access left there (writing the same value again
+// would not change the EEPROM either); the word at EEBLOCK and EEOFFSET is then made readable.
+EEPROM_Type * SimEeprom(void)
+{
+    start();
+
+    if (Eeprom.EERDWR != EepromShown)
+        EepromWords[(Eeprom.EEBLOCK % EEPROM_BLOCKS) * EEPROM_BLOCK_WORDS + Eeprom.EEOFFSET % EEPROM_BLOCK_WORDS] =
+            Eeprom.EERDWR;
+
+    EepromShown = Eeprom.EERDWR =
+        EepromWords[(Eeprom.EEBLOCK % EEPROM_BLOCKS) * EEPROM_BLOCK_WORDS + Eeprom.EEOFFSET % EEPROM_BLOCK_WORDS];
+    Eeprom.EEDONE = 0;
+    Eeprom.EESUPP = 0;
+    return &Eeprom;
+}
+
+// UARTDR: the index into DR_BITS of every access (see TM4C123GH6PM.h). The access itself comes after the
+// call, so it is not known yet whether it reads or writes; the next call (or the next update) tells, as a store
+// replaces the word left here. Until then a read is assumed: the receive FIFO gives up its oldest character,
+// and UARTFR shows the transmit FIFO as it would be after a store.
+uint32_t SimUartDr(void)
+{
+    uint32_t value = 0;
+    uint32_t i;
+
+    updateUart();
+
+    UartPopped = (UartRxHead != UartRxTail);
+    if (UartPopped)
+        value = UartRx[UartRxTail++ % UART_FIFO_SZ];
+
+    UartShown = value;
+    for (i = 0; i < 8; i++)
+        SimUart[i].DR_BITS[0] = UART_DR_SHOWN | ((i == 0) ? value : 0);
+    UartAccess = 1;
+
+    setUartFlags(1);
+    return 0;
+}
+
+// MSP as the firmware sees it: the top of the STACK section, i.e. nothing is in use yet
+uintptr_t SimMsp(void)
+{
+    return (uintptr_t)&STACK$$Limit;
+}
+
+// The main loop is asleep: run the interrupts that are due, or move the virtual time on to the next one.
+// Returns (wakes the main loop) once a handler has run.
+void SimIdle(void)
+{
+    uint32_t wake = Now;
+
+    // Time moves by the wake ups here, not by the accesses that look for them
+    for (;;)
+    {
+        Spin = 0;
+        if (serviceDue())
+            break;
+        if (!nextWake(&wake))
+            finish();
+        Now = wake;
+    }
+    Spin = 0;
+}
+
+// Reset: the state of the last run (SIM_STATE) and the first trace event. Called by the first register access.
+static void start(void)
+{
+    static uint32_t started;
+    static sim_state_t state;
+    const char * name = getenv("SIM_STATE");
+    const char * off = getenv("SIM_OFF");
+    FILE * file;
+
+    if (started)
+        return;
+    started = 1;
+
+    memset(EepromWords, 0xFF, sizeof(EepromWords));
+    Hib.RTCLD = HIB_RTCLD_NONE;
+
+    // Reset values: 16MHz PIOSC with the PLL bypassed, PLLFREQ set for 400MHz (see ClockRead())
+    Sysctl.RCC      = 0x078E3AD1;
+    Sysctl.RCC2     = 0x07C06810;
+    Sysctl.PLLFREQ0 = 0x00000032;
+    Sysctl.PLLFREQ1 = 0x00000001;
+
+    if (name != 0 && (file = fopen(name, "rb")) != 0)
+    {
+        if (fread(&state, sizeof(state), 1, file) == 1)
+        {
+            RtcBase  = state.rtcc + (off != 0 ? (uint32_t)strtoul(off, 0, 10) : 0);
+            Hib.RTCC = RtcBase;
+            Hib.CTL  = state.ctl;
+            Hib.DATA = state.data;
+            memcpy(EepromWords, state.eeprom, sizeof(EepromWords));
+        }
+        fclose(file);
+    }
+
+    readTrace();
+}
+
+// Runs everything due at Now. Returns the number of handlers run.
+static uint32_t serviceDue(void)
+{
+    uint32_t before = Interrupts;
+    HIB_Type * hib;
+    uint32_t i;
+
+    while (Next.type != TRACE_NONE && (int32_t)(Next.time - Now) <= 0)
+    {
+        applyTrace(&Next);
+        readTrace();
+    }
+
+    // Interrupts pended by software (NVIC ISPRn, STIR); ISPR is write 1 to set
+    for (i = 0; i < 3; i++)
+    {
+        uint32_t pending = SimNvic.ISPR[i];
+
+        SimNvic.ISPR[i] = 0;
+        while (pending != 0)
+        {
+            uint32_t bit = 31 - __CLZ(pending);
+
+            pending &= ~(1U << bit);
+            interrupt(i * 32 + bit);
+        }
+    }
+    if (SimNvic.STIR != 0)
+    {
+        uint32_t irq = SimNvic.STIR;
+
+        SimNvic.STIR = 0;
+        interrupt(irq);
+    }
+
+    if (SimGpioF()->MIS & SWITCH_PINS)
+        interrupt(IRQ_GPIOF);
+
+    updateUart();
+    if (SimUart[0].MIS != 0)
+        interrupt(IRQ_UART0);
+
+    SimWtimer0();
+    if (OneShotArmed && (int32_t)(OneShotDeadline - Now) <= 0)
+    {
+        Wtimer0.CTL &= ~GPTM_CTL_TBEN;
+        OneShotArmed = 0;
+        Wtimer0.RIS |= GPTM_INT_TBTO;
+        interrupt(IRQ_WTIMER0B);
+    }
+    if ((Wtimer0.IMR & GPTM_INT_TAM) && (int32_t)((0xFFFFFFFF - Wtimer0.TAMATCHR) - Now) <= 0)
+    {
+        Wtimer0.RIS |= GPTM_INT_TAM;
+        interrupt(IRQ_WTIMER0A);
+    }
+
+    hib = SimHib();
+    if ((hib->IM & HIB_INT_RTCALT0) && (hib->CTL & HIB_CTL_RTCEN) && (int32_t)(hib->RTCC - hib->RTCM0) >= 0)
+    {
+        hib->RIS |= HIB_INT_RTCALT0;
+        interrupt(IRQ_HIB);
+    }
+
+    return Interrupts - before;
+}
+
+// Earliest time something can happen. Returns 0 if nothing ever will.
+static uint32_t nextWake(uint32_t * const wake)
+{
+    uint32_t times[7];
+    uint32_t count = 0;
+    uint32_t i;
+
+    updateUart();
+    if (UartTxHead != UartTxTail)
+        times[count++] = UartTxDone;
+    if (UartLineHead != UartLineTail)
+        times[count++] = UartLineNext;
+    if (UartRtArmed)
+        times[count++] = UartRxLast + SIM_UART_RT_TIME;
+    if (Next.type != TRACE_NONE)
+        times[count++] = Next.time;
+    if (SimWtimer0(), OneShotArmed)
+        times[count++] = OneShotDeadline;
+    if (Wtimer0.IMR & GPTM_INT_TAM)
+        times[count++] = 0xFFFFFFFF - Wtimer0.TAMATCHR;
+    if ((SimHib()->IM & HIB_INT_RTCALT0) && (Hib.CTL & HIB_CTL_RTCEN))
+        times[count++] = RtcLoaded + (Hib.RTCM0 - RtcBase) * 1000;
+
+    // Without a trace event to come only the end of the trace, and the characters still on the line, stop the
+    // clock
+    if (Next.type == TRACE_NONE && UartLineHead == UartLineTail && !UartRtArmed && UartTxHead == UartTxTail)
+        return 0;
+
+    *wake = times[0];
+    for (i = 1; i < count; i++)
+    {
+        if ((int32_t)(times[i] - *wake) < 0)
+            *wake = times[i];
+    }
+    if ((int32_t)(*wake - Now) < 0)
+        *wake = Now;
+    return 1;
+}
+
+static void interrupt(const uint32_t irq)
+{
+    Interrupts++;
+
+    switch (irq)
+    {
+    case IRQ_UART0:
+        UART0_Handler();
+        break;
+
+    case IRQ_GPIOF:
+        GPIOF_Handler();
+        break;
+
+    case IRQ_HIB:
+        HIB_Handler();
+        break;
+
+    case IRQ_WTIMER0A:
+        WTIMER0A_Handler();
+        break;
+
+    case IRQ_WTIMER0B:
+        WTIMER0B_Handler();
+        break;
+
+    default:
+        Interrupts--;
+        break;
+    }
+}
+
+// Bring UART0 up to the virtual time: the UARTDR access since the last call, UARTICR, the line, the transmit
+// shift register and then UARTFR, UARTRIS and UARTMIS
+static void updateUart(void)
+{
+    UART0_Type * const uart = &SimUart[0];
+    const uint32_t rxLevel = UartLevels[(uart->IFLS >> 3) & 7];
+    const uint32_t txLevel = UartLevels[uart->IFLS & 7];
+    uint32_t i;
+
+    if (UartAccess)
+    {
+        UartAccess = 0;
+        for (i = 0; i < 8; i++)
+        {
+            uint32_t word = SimUart[i].DR_BITS[0];
+
+            // A char stored from the firmware's buffers may be sign extended, so compare the whole word
+            if (word == (UART_DR_SHOWN | ((i == 0) ? UartShown : 0)))
+                continue;
+
+            // A store: it was not a read after all. The other instances send nowhere.
+            if (i == 0 && UartPopped)
+                UartRxTail--;
+            if (i == 0 && UartTxHead - UartTxTail < UART_FIFO_SZ)
+            {
+                if (UartTxHead == UartTxTail)
+                    UartTxDone = Now + SIM_UART_CHAR_TIME;
+                UartTx[UartTxHead++ % UART_FIFO_SZ] = (uint8_t)word;
+            }
+        }
+        UartPopped = 0;
+    }
+
+    uart->RIS &= ~uart->ICR;
+    uart->ICR = 0;
+
+    while (UartLineHead != UartLineTail && (int32_t)(UartLineNext - Now) <= 0)
+    {
+        if (UartRxHead - UartRxTail < UART_FIFO_SZ)
+            UartRx[UartRxHead++ % UART_FIFO_SZ] = UartLine[UartLineTail % SIM_UART_LINE_SZ];
+        else
+            uart->RIS |= UART_INT_OE;
+        UartLineTail++;
+        UartRxLast   = UartLineNext;
+        UartRtArmed  = 1;
+        UartLineNext += SIM_UART_CHAR_TIME;
+    }
+
+    // TXRIS is set as the FIFO drains to the level, and cleared by a store that fills it past the level
+    while (UartTxHead != UartTxTail && (int32_t)(UartTxDone - Now) <= 0)
+    {
+        putchar(UartTx[UartTxTail++ % UART_FIFO_SZ]);
+        if (UartTxHead - UartTxTail == txLevel)
+            uart->RIS |= UART_INT_TX;
+        UartTxDone += SIM_UART_CHAR_TIME;
+    }
+    if (UartTxHead - UartTxTail > txLevel)
+        uart->RIS &= ~UART_INT_TX;
+
+    // RXRIS follows the FIFO level; RTRIS is set once the line has been quiet for SIM_UART_RT_TIME
+    if (UartRxHead - UartRxTail >= rxLevel)
+        uart->RIS |= UART_INT_RX;
+    else
+        uart->RIS &= ~UART_INT_RX;
+    if (UartRxHead == UartRxTail)
+    {
+        UartRtArmed = 0;
+        uart->RIS &= ~UART_INT_RT;
+    }
+    else if (UartRtArmed && (int32_t)(UartRxLast + SIM_UART_RT_TIME - Now) <= 0)
+    {
+        UartRtArmed = 0;
+        uart->RIS |= UART_INT_RT;
+    }
+
+    setUartFlags(0);
+    uart->MIS = uart->RIS & uart->IM;
+}
+
+// UARTFR from the FIFOs; write counts a store about to be made. BUSY never shows: a character is as good as
+// sent when the firmware waits for it (UartSetClock()).
+static void setUartFlags(const uint32_t write)
+{
+    uint32_t rx = UartRxHead - UartRxTail;
+    uint32_t tx = UartTxHead - UartTxTail;
+
+    SimUart[0].FR = ((rx == 0) ? UART_FR_RXFE : 0) | ((rx == UART_FIFO_SZ) ? UART_FR_RXFF : 0) |
+                    ((tx + write >= UART_FIFO_SZ) ? UART_FR_TXFF : 0) | ((tx == 0) ? UART_FR_TXFE : 0);
+}
+
+static void applyTrace(const trace_event_t * const event)
+{
+    uint32_t i;
+
+    TraceEvents++;
+
+    switch (event->type)
+    {
+    case TRACE_PRESS:
+        setLevels(Levels & ~event->pins);
+        break;
+
+    case TRACE_RELEASE:
+        setLevels(Levels | event->pins);
+        break;
+
+    case TRACE_RECEIVE:
+        if (UartLineHead == UartLineTail)
+            UartLineNext = Now + SIM_UART_CHAR_TIME;
+        for (i = 0; i < event->count && UartLineHead - UartLineTail < SIM_UART_LINE_SZ; i++)
+            UartLine[UartLineHead++ % SIM_UART_LINE_SZ] = event->bytes[i];
+        break;
+
+    default:
+        finish();
+        break;
+    }
+}
+
+// Latch the edges the pins are unmasked for (GPIOIS, GPIOIBE clear: GPIOIEV selects the edge). An edge on a
+// masked pin is not latched: the firmware clears a masked pin's GPIORIS before unmasking it, and no time
+// passes in between here.
+static void setLevels(const uint32_t levels)
+{
+    uint32_t rising  = levels & ~Levels;
+    uint32_t falling = Levels & ~levels;
+    uint32_t i;
+
+    Levels = levels;
+    GpioF.DATA = levels;
+    for (i = 0; i < 255; i++)
+        GpioF.DATA_BITS[i] = levels & i;
+
+    GpioF.RIS |= ((rising & GpioF.IEV) | (falling & ~GpioF.IEV)) & GpioF.IM;
+}
+
+// Read the next trace event into Next
+static void readTrace(void)
+{
+    char line[TRACE_LINE_SZ];
+    char type[16];
+    unsigned long time;
+    int used;
+
+    Next.type = TRACE_NONE;
+
+    while (fgets(line, sizeof(line), stdin) != 0)
+    {
+        const char * args;
+        unsigned int value;
+        int n;
+
+        TraceLine++;
+        if (sscanf(line, " %lu %15s %n", &time, type, &used) != 2)
+            continue;                           // blank line or comment
+        args = line + used;
+
+        Next.time  = (uint32_t)time;
+        Next.count = 0;
+
+        if (strcmp(type, "end") == 0)
+        {
+            Next.type = TRACE_END;
+        }
+        else if (strcmp(type, "press") == 0 || strcmp(type, "release") == 0)
+        {
+            Next.type = (type[0] == 'p') ? TRACE_PRESS : TRACE_RELEASE;
+            Next.pins = (args[0] == '1') ? (1U << SWITCH_1_PIN) : (args[0] == '2') ? (1U << SWITCH_2_PIN) : 0;
+        }
+        else if (strcmp(type, "key") == 0 && args[0] != '\0' && args[0] != '\n' && args[0] != '\r')
+        {
+            Next.type     = TRACE_RECEIVE;
+            Next.bytes[0] = (uint8_t)args[0];
+            Next.count    = 1;
+        }
+        else if (strcmp(type, "send") == 0)
+        {
+            Next.type = TRACE_RECEIVE;
+            while (sscanf(args, "%x%n", &value, &n) == 1)
+            {
+                Next.bytes[Next.count++] = (uint8_t)value;
+                args += n;
+            }
+        }
+
+        if (Next.type == TRACE_NONE || (Next.type <= TRACE_RELEASE && Next.pins == 0))
+        {
+            fprintf(stderr, "sim: line %lu: bad event\n", (unsigned long)TraceLine);
+            exit(2);
+        }
+        return;
+    }
+}
+
+static void finish(void)
+{
+    static sim_state_t state;
+    const char * name = getenv("SIM_STATE");
+    double host = (double)clock() / CLOCKS_PER_SEC;
+    FILE * file;
+
+    // Send what is left: the transmit interrupt refills the FIFO from the driver's buffer
+    for (;;)
+    {
+        updateUart();
+        if (SimUart[0].MIS & UART_INT_TX)
+            interrupt(IRQ_UART0);
+        else if (UartTxHead != UartTxTail)
+            Now = UartTxDone;
+        else
+            break;
+    }
+
+    if (name != 0 && (file = fopen(name, "wb")) != 0)
+    {
+        state.rtcc = SimHib()->RTCC;
+        state.ctl  = Hib.CTL;
+        state.data = Hib.DATA;
+        memcpy(state.eeprom, EepromWords, sizeof(EepromWords));
+        fwrite(&state, sizeof(state), 1, file);
+        fclose(file);
+    }
+
+    fflush(stdout);
+    fprintf(stderr, "\nsim: %lu ms virtual, %lu trace events, %lu interrupts, %.3f s host",
+            (unsigned long)Now, (unsigned long)TraceEvents, (unsigned long)Interrupts, host);
+    if (Interrupts != 0)
+        fprintf(stderr, ", %.0f ns per interrupt", host * 1e9 / Interrupts);
+    if (host > 0)
+        fprintf(stderr, ", %.0fx real time", Now / 1000.0 / host);
+    fprintf(stderr, "\n");
+    exit(0);
+}
@@ -0,0 +1,29 @@
+#ifndef SIMRTNS_H
+#define SIMRTNS_H
+
+#include <stdint.h>
+
+// Register blocks of the host simulation; included by the simulated TM4C123GH6PM.h (see simrtns.c)
+extern GPIOA_Type SimGpio[5];               // Ports A to E; Port F is SimGpioF()
+extern UART0_Type SimUart[8];
+extern UDMA_Type SimUdma;
+extern PWM0_Type SimPwm[2];
+extern SysTick_Type SimSysTick;
+extern NVIC_Type SimNvic;
+extern SCB_Type SimScb;
+extern DWT_Type SimDwt;
+extern CoreDebug_Type SimCoreDebug;
+extern ITM_Type SimItm;
+extern TPI_Type SimTpi;
+
+SYSCTL_Type * SimSysctl         (void);
+GPIOA_Type * SimGpioF           (void);
+WTIMER0_Type * SimWtimer0       (void);
+HIB_Type * SimHib               (void);
+EEPROM_Type * SimEeprom         (void);
+uint32_t SimUartDr              (void);
+
+void SimIdle                    (void);
+uintptr_t SimMsp                (void);
+
+#endif // SIMRTNS_H
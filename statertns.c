@@ -0,0 +1,105 @@
+// Alarm checkpoints: an append-only record log in the EEPROM (see eepromrtns.c).
+//
+// Each record fills one EEPROM block: a sequence number, the expiry of every alarm in RTC seconds (HIBRTCC; see
+// RtcCounter()) and a check word. StateSave() writes the next record into the block after the newest one, so
+// the writes go round all EEPROM_BLOCKS blocks in turn and the newest record is never overwritten: a save cut
+// short by a reset leaves a record that fails its check, and the one before it is used. StateInit() reads every
+// block once at start up to find the newest valid record and the block to write next.
+
+#include "eepromrtns.h"
+#include "statertns.h"
+
+#if ALARM_COUNT + 2 > EEPROM_BLOCK_WORDS
+#error "An alarm record must fit in an EEPROM block"
+#endif
+
+#define STATE_SEQUENCE          0
+#define STATE_EXPIRY            1
+#define STATE_CHECK             (STATE_EXPIRY + ALARM_COUNT)
+#define STATE_WORDS             (STATE_CHECK + 1)
+
+#define STATE_MAGIC             0x414C4D31      // "ALM1"
+
+static uint32_t Usable;
+static uint32_t Newest;         // block of the newest valid record, EEPROM_BLOCKS if there is none
+static uint32_t Sequence;       // of the newest record
+
+static uint32_t check(const uint32_t * const record);
+
+// Returns 1 if a valid record was found
+uint32_t StateInit(void)
+{
+    uint32_t record[STATE_WORDS];
+    uint32_t block;
+
+    Newest = EEPROM_BLOCKS;
+    Sequence = 0;
+
+    Usable = EepromInit();
+    if (!Usable)
+        return 0;
+
+    for (block = 0; block < EEPROM_BLOCKS; block++)
+    {
+        EepromRead(block, record, STATE_WORDS);
+        if (record[STATE_CHECK] != check(record))
+            continue;
+
+        // Sequence numbers wrap; the records in the log are never far apart
+        if (Newest == EEPROM_BLOCKS || (int32_t)(record[STATE_SEQUENCE] - Sequence) > 0)
+        {
+            Newest = block;
+            Sequence = record[STATE_SEQUENCE];
+        }
+    }
+    return Newest != EEPROM_BLOCKS;
+}
+
+// Copies the alarms of the newest record. Returns 0 if there is none.
+uint32_t StateLoad(uint32_t expiry[ALARM_COUNT])
+{
+    uint32_t record[STATE_WORDS];
+    uint32_t i;
+
+    if (Newest == EEPROM_BLOCKS)
+        return 0;
+
+    EepromRead(Newest, record, STATE_WORDS);
+    for (i = 0; i < ALARM_COUNT; i++)
+        expiry[i] = record[STATE_EXPIRY + i];
+    return 1;
+}
+
+// Appends a record. Returns 1 if it was written.
+uint32_t StateSave(const uint32_t expiry[ALARM_COUNT])
+{
+    uint32_t record[STATE_WORDS];
+    uint32_t block = (Newest == EEPROM_BLOCKS) ? 0 : (Newest + 1) % EEPROM_BLOCKS;
+    uint32_t i;
+
+    if (!Usable)
+        return 0;
+
+    record[STATE_SEQUENCE] = Sequence + 1;
+    for (i = 0; i < ALARM_COUNT; i++)
+        record[STATE_EXPIRY + i] = expiry[i];
+    record[STATE_CHECK] = check(record);
+
+    if (!EepromWrite(block, record, STATE_WORDS))
+        return 0;
+
+    Newest = block;
+    Sequence++;
+    return 1;
+}
+
+// A block that has never been written (all 0xFFFFFFFF) does not pass
+static uint32_t check(const uint32_t * const record)
+{
+    uint32_t sum = STATE_MAGIC;
+    uint32_t i;
+
+    for (i = 0; i < STATE_CHECK; i++)
+        sum = (sum << 1 | sum >> 31) + record[i];
+    return sum;
+}
@@ -0,0 +1,15 @@
+#ifndef STATERTNS_H
+#define STATERTNS_H
+
+#include "stdint.h"
+
+#include "alarmrtns.h"
+
+// Expiry of an unused alarm in a record
+#define STATE_NO_ALARM          0xFFFFFFFF
+
+uint32_t StateInit              (void);
+uint32_t StateLoad              (uint32_t expiry[ALARM_COUNT]);
+uint32_t StateSave              (const uint32_t expiry[ALARM_COUNT]);
+
+#endif // STATERTNS_H
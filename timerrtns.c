@@ -0,0 +1,253 @@
+// Software timers on a hashed timer wheel, driven by Wide Timer 0 A.
+//
+// WTimer0A runs as a free running 32 bit periodic down counter with a 16 bit prescaler dividing PIOSC by 16000,
+// so it counts milliseconds for 49.7 days before wrapping (see 11.4.2 Periodic Timer Mode). It is clocked from
+// PIOSC (GPTMCC ALTCLK) so that the tick does not depend on the system clock. TimerNow() is the elapsed count;
+// all comparisons use unsigned subtraction so the 32 bit wrap is harmless.
+//
+// A timer is stored in the wheel slot given by the low bits of its expiry tick. Starting and cancelling is O(1);
+// TimerService() only looks at the slots for the ticks that have passed since it last ran. The match interrupt
+// (TnMIE) is armed for the earliest expiry before the main loop sleeps, so there is no periodic tick interrupt.
+
+#include "TM4C123GH6PM.h"
+
+#include "timerrtns.h"
+
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SZ - 1)
+
+#if (TIMER_WHEEL_SZ & TIMER_WHEEL_MASK) != 0
+#error "TIMER_WHEEL_SZ must be a power of two"
+#endif
+
+#define TIMER_PRESCALE          (16000 - 1)     // PIOSC 16MHz / 16000 = 1ms
+
+#define GPTM_INT_TAM            (1U << 4)       // GPTMIMR/GPTMICR: timer A match interrupt
+
+// True if the expiry tick is now or in the past
+#define EXPIRED(expiry, now)    ((int32_t)((expiry) - (now)) <= 0)
+
+typedef enum
+{
+    TIMER_IDLE = 0,
+    TIMER_RUNNING,
+    TIMER_EXPIRED               // taken off the wheel, callback not run yet
+} timer_state_t;
+
+typedef struct swtimer
+{
+    struct swtimer *  next;
+    struct swtimer *  prev;
+    uint32_t          expiry;
+    uint32_t          slot;     // wheel slot while running
+    timer_callback_t  callback;
+    timer_state_t     state;
+} swtimer_t;
+
+static swtimer_t Timers[TIMER_COUNT];
+static swtimer_t * Wheel[TIMER_WHEEL_SZ];
+
+// Every slot up to and including this tick has been serviced
+static uint32_t LastServiced;
+
+static void insert(swtimer_t * const timer);
+static void unlink(swtimer_t * const timer);
+
+void TimerInit(void)
+{
+    // Enable the clock to Wide Timer 0 (RCGCWTIMER) and wait for PRWTIMER; see UartEnable().
+    SYSCTL->RCGCWTIMER |= (1 << 0);
+    while ((SYSCTL->PRWTIMER & (1 << 0)) == 0);
+
+    // Periodic timer mode; see 11.4.2 steps 1 to 7.
+    WTIMER0->CTL   &= ~(1U << 0);                   // TAEN: disable timer A while we configure it
+    WTIMER0->CFG   = 0x4;                           // 32 bit timers (for a 32/64 bit wide timer)
+    WTIMER0->TAMR  = (1 << 5) | 0x2;                // TAMIE (match interrupt), periodic, count down
+    WTIMER0->CC    = (1 << 0);                      // ALTCLK: clock from ALTCLKCFG i.e. PIOSC
+    SYSCTL->ALTCLKCFG = 0x0;                        // PIOSC
+    WTIMER0->TAPR  = TIMER_PRESCALE;
+    WTIMER0->TAILR = 0xFFFFFFFF;
+    WTIMER0->ICR   = GPTM_INT_TAM;
+    WTIMER0->CTL  |= (1 << 0);                      // TAEN
+
+    LastServiced = TimerNow();
+
+    // Wide Timer 0A is interrupt number 94 (see startup_TM4C123.s; look for WTIMER0A_Handler)
+    // m = 94 / 32 = 2; hence we update ISER[2]; b = 94 % 32 = 30; hence we set bit 30.
+    NVIC->IP[94] = 3 << 5;      // Same priority as GPIOF
+    NVIC->ISER[2] = (1 << 30);
+}
+
+// Milliseconds since TimerInit(); safe to call from interrupt handlers.
+uint32_t TimerNow(void)
+{
+    return 0xFFFFFFFF - WTIMER0->TAR;
+}
+
+// Start (or restart) a timer to expire ms milliseconds from now.
+void TimerStart(const uint32_t id,
+                const uint32_t ms,
+                const timer_callback_t callback)
+{
+    swtimer_t * const timer = &Timers[id];
+
+    if (timer->state == TIMER_RUNNING)
+        unlink(timer);
+
+    timer->expiry   = TimerNow() + ms;
+    timer->callback = callback;
+    insert(timer);
+}
+
+// Start a timer ms milliseconds after its previous expiry. Used by periodic callbacks so that the time taken
+// to get round to TimerService() does not accumulate.
+void TimerRestart(const uint32_t id,
+                  const uint32_t ms)
+{
+    swtimer_t * const timer = &Timers[id];
+
+    if (timer->state == TIMER_RUNNING)
+        unlink(timer);
+
+    timer->expiry += ms;
+    insert(timer);
+}
+
+void TimerCancel(const uint32_t id)
+{
+    swtimer_t * const timer = &Timers[id];
+
+    if (timer->state == TIMER_RUNNING)
+        unlink(timer);
+
+    timer->state = TIMER_IDLE;
+}
+
+uint32_t TimerActive(const uint32_t id)
+{
+    return Timers[id].state != TIMER_IDLE;
+}
+
+// Run the callbacks of all expired timers; called from the main loop.
+void TimerService(void)
+{
+    uint32_t now = TimerNow();
+    uint32_t count = now - LastServiced;
+    uint32_t tick;
+    uint8_t expired[TIMER_COUNT];
+    uint32_t expiredCount = 0;
+    uint32_t i;
+
+    if (count == 0)
+        return;
+
+    // After a long sleep visiting every slot once is enough; later rounds stay on the wheel.
+    if (count > TIMER_WHEEL_SZ)
+        count = TIMER_WHEEL_SZ;
+
+    // Take the expired timers off the wheel first; callbacks may start and cancel timers.
+    for (tick = now - count + 1; count != 0; tick++, count--)
+    {
+        swtimer_t * timer = Wheel[tick & TIMER_WHEEL_MASK];
+
+        while (timer != 0)
+        {
+            swtimer_t * const next = timer->next;
+
+            if (EXPIRED(timer->expiry, now))
+            {
+                unlink(timer);
+                timer->state = TIMER_EXPIRED;
+                expired[expiredCount++] = (uint8_t)(timer - Timers);
+            }
+            timer = next;
+        }
+    }
+    LastServiced = now;
+
+    for (i = 0; i < expiredCount; i++)
+    {
+        swtimer_t * const timer = &Timers[expired[i]];
+
+        // Skip timers cancelled or restarted by an earlier callback
+        if (timer->state == TIMER_EXPIRED)
+        {
+            timer->state = TIMER_IDLE;
+            timer->callback(expired[i]);
+        }
+    }
+}
+
+// Arm the match interrupt for the earliest running timer before the main loop sleeps. Call with interrupts
+// disabled. Returns 0 if a timer is already due, in which case the caller must not sleep.
+uint32_t TimerArm(void)
+{
+    uint32_t now = TimerNow();
+    uint32_t earliest = 0;
+    uint32_t running = 0;
+    uint32_t i;
+
+    for (i = 0; i < TIMER_COUNT; i++)
+    {
+        if (Timers[i].state == TIMER_EXPIRED)
+            return 0;
+
+        if (Timers[i].state == TIMER_RUNNING)
+        {
+            if (running == 0 || (int32_t)(Timers[i].expiry - earliest) < 0)
+                earliest = Timers[i].expiry;
+            running = 1;
+        }
+    }
+
+    if (running == 0)
+    {
+        WTIMER0->IMR &= ~GPTM_INT_TAM;              // nothing to wake up for
+        return 1;
+    }
+
+    if (EXPIRED(earliest, now))
+        return 0;
+
+    // The counter counts down; the match fires when timer A and its prescaler reach these values
+    WTIMER0->TAMATCHR = 0xFFFFFFFF - earliest;
+    WTIMER0->TAPMR    = 0;
+    WTIMER0->ICR      = GPTM_INT_TAM;
+    WTIMER0->IMR     |= GPTM_INT_TAM;
+    return 1;
+}
+
+// Called from WTIMER0A_Handler. The match only wakes the main loop; TimerService() does the work.
+void TimerHandler(void)
+{
+    WTIMER0->ICR  = GPTM_INT_TAM;
+    WTIMER0->IMR &= ~GPTM_INT_TAM;
+}
+
+static void insert(swtimer_t * const timer)
+{
+    // A timer that is already due goes in the next slot to be serviced, not one that has just been passed
+    uint32_t tick = EXPIRED(timer->expiry, LastServiced) ? LastServiced + 1 : timer->expiry;
+    swtimer_t ** const slot = &Wheel[tick & TIMER_WHEEL_MASK];
+
+    timer->slot = tick & TIMER_WHEEL_MASK;
+    timer->prev = 0;
+    timer->next = *slot;
+    if (*slot != 0)
+        (*slot)->prev = timer;
+    *slot = timer;
+
+    timer->state = TIMER_RUNNING;
+}
+
+static void unlink(swtimer_t * const timer)
+{
+    if (timer->prev != 0)
+        timer->prev->next = timer->next;
+    else
+        Wheel[timer->slot] = timer->next;
+
+    if (timer->next != 0)
+        timer->next->prev = timer->prev;
+
+    timer->next = timer->prev = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef TIMERRTNS_H
+#define TIMERRTNS_H
+
+#include "stdint.h"
+
+// Software timers; ids are 0 .. TIMER_COUNT - 1
+#define TIMER_COUNT             8
+
+// Timer wheel slots, one per millisecond; must be a power of two
+#define TIMER_WHEEL_SZ          64
+
+// Runs from TimerService() i.e. in the main loop, not in interrupt context
+typedef void (*timer_callback_t)(const uint32_t id);
+
+void TimerInit                  (void);
+uint32_t TimerNow               (void);
+
+void TimerStart                 (const uint32_t id,
+                                 const uint32_t ms,
+                                 const timer_callback_t callback);
+void TimerRestart               (const uint32_t id,
+                                 const uint32_t ms);
+void TimerCancel                (const uint32_t id);
+uint32_t TimerActive            (const uint32_t id);
+
+void TimerService               (void);
+uint32_t TimerArm               (void);
+void TimerHandler               (void);
+
+#endif // TIMERRTNS_H
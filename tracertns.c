@@ -0,0 +1,175 @@
+// Binary event trace for post-mortem debugging: what the switches, the timer interrupts, the state machine and
+// the led did before a fault or a reset.
+//
+// An entry is one word: the milliseconds since the previous entry (TimerNow()) in bits 31:16, the trace_id_t in
+// bits 15:8 and an 8 bit payload in bits 7:0. A longer gap is written as a TRACE_GAP entry carrying the upper
+// bits first. TraceRecord() runs from the handlers and the main loop alike, so it takes PRIMASK for the few
+// instructions that read the time and claim the slot; it is a timer read and one or two stores, not the
+// hundreds of cycles printString() needs to format and queue text.
+//
+// The ring and its index are in .bss.noinit, so a warm reset (the reset button, a watchdog, a fault handler's
+// SYSRESETREQ) keeps them; TraceInit() then carries on from the old entries, starting with a TRACE_RESET entry
+// that records the reset cause. With Keil the scatter file must place .bss.noinit in an UNINIT region, e.g.
+//   RW_NOINIT +0 UNINIT { *(.bss.noinit) }
+// otherwise the section is zeroed with the rest of .bss and every reset starts an empty trace. After power on
+// the contents are random; TraceMagic tells them apart.
+//
+// 't' dumps the ring, oldest entry first: a "trace <count>" row, then the entries as eight digit hex words,
+// TRACE_ROW_ENTRIES per row. As for the profiling table (see ProfService()) a row is only queued when the DIAG_TRACE
+// channel has room for it. Nothing is recorded until the dump is complete.
+
+#include "TM4C123GH6PM.h"
+
+#include "diagrtns.h"
+#include "fmtrtns.h"
+#include "timerrtns.h"
+#include "tracertns.h"
+
+#ifdef TRACE
+
+#define TRACE_MASK              (TRACE_ENTRIES - 1)
+
+#if (TRACE_ENTRIES & TRACE_MASK) != 0
+#error "TRACE_ENTRIES must be a power of two"
+#endif
+
+#define TRACE_MAGIC             0x54524331      // "TRC1"
+#define TRACE_NOINIT            __attribute__((section(".bss.noinit")))
+#define TRACE_DELTA_MAX         0xFFFF
+
+#define TRACE_ROW_ENTRIES       8
+#define TRACE_NOT_DUMPING       0xFFFFFFFF
+
+// "trace" and a number, or the entries with a leading space each; "\n\r" and the NUL
+#define TRACE_ROW_SZ            (TRACE_ROW_ENTRIES * FMT_HEX_SZ + 2 + 1)
+
+static uint32_t Ring[TRACE_ENTRIES] TRACE_NOINIT;
+static volatile uint32_t Head TRACE_NOINIT;     // runs freely; masked on use
+static uint32_t TraceMagic TRACE_NOINIT;
+
+static uint32_t Last;                           // TimerNow() at the newest entry
+static volatile uint32_t Dumping = TRACE_NOT_DUMPING;   // next entry to send
+static uint32_t DumpEnd;
+static uint32_t DumpHeader;                     // the "trace" row has been sent
+
+static uint32_t appendEntries(char * const row,
+                              uint32_t length);
+
+// Call once the timers run. Keeps the entries of a warm reset.
+void TraceInit(void)
+{
+    if (TraceMagic != TRACE_MAGIC)
+    {
+        Head = 0;
+        TraceMagic = TRACE_MAGIC;
+    }
+
+    // TimerNow() restarts at 0, so the reset entry has no delta
+    Last = TimerNow();
+    TraceRecord(TRACE_RESET, SYSCTL->RESC);
+    SYSCTL->RESC = 0;           // so that the next reset shows only its own cause
+}
+
+void TraceRecord(const trace_id_t id,
+                 const uint32_t payload)
+{
+    uint32_t primask;
+    uint32_t now;
+    uint32_t delta;
+    uint32_t head;
+
+    if (Dumping != TRACE_NOT_DUMPING)
+        return;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    now = TimerNow();
+    delta = now - Last;
+    Last = now;
+    head = Head;
+
+    if (delta > TRACE_DELTA_MAX)
+    {
+        uint32_t high = delta >> 16;
+
+        Ring[head++ & TRACE_MASK] = ((high > TRACE_DELTA_MAX ? TRACE_DELTA_MAX : high) << 16) |
+                                    ((uint32_t)TRACE_GAP << 8);
+        delta &= TRACE_DELTA_MAX;
+    }
+    Ring[head++ & TRACE_MASK] = (delta << 16) | ((uint32_t)id << 8) | (payload & 0xFF);
+    Head = head;
+
+    __set_PRIMASK(primask);
+}
+
+// Start sending the ring
+void TraceDump(void)
+{
+    uint32_t head = Head;
+
+    DumpHeader = 0;
+    DumpEnd = head;
+    Dumping = (head > TRACE_ENTRIES) ? head - TRACE_ENTRIES : 0;
+}
+
+// Called from the main loop; sends the next rows of a dump. Returns 1 once the last row has been queued.
+uint32_t TraceService(void)
+{
+    while (Dumping != TRACE_NOT_DUMPING)
+    {
+        char row[TRACE_ROW_SZ];
+        uint32_t length;
+
+        if (!DumpHeader)
+        {
+            const char * title = "trace ";
+
+            length = 0;
+            while (*title)
+                row[length++] = *title++;
+            length += FmtUnsigned(&row[length], DumpEnd - Dumping);
+        }
+        else
+        {
+            length = appendEntries(row, 0);
+        }
+        row[length++] = '\n';
+        row[length++] = '\r';
+        row[length] = '\0';
+
+        if (DiagSpace(DIAG_TRACE) < length)
+            return 0;
+
+        DiagWrite(DIAG_TRACE, row);
+        if (!DumpHeader)
+        {
+            DumpHeader = 1;
+            continue;
+        }
+
+        Dumping += (DumpEnd - Dumping < TRACE_ROW_ENTRIES) ? DumpEnd - Dumping : TRACE_ROW_ENTRIES;
+        if (Dumping == DumpEnd)
+        {
+            Dumping = TRACE_NOT_DUMPING;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// The entries of the next row, each with a leading space
+static uint32_t appendEntries(char * const row,
+                              uint32_t length)
+{
+    uint32_t i;
+
+    for (i = Dumping; i != DumpEnd && i - Dumping < TRACE_ROW_ENTRIES; i++)
+    {
+        row[length++] = ' ';
+        length += FmtHex(&row[length], Ring[i & TRACE_MASK], 8);
+    }
+    return length;
+}
+
+#endif // TRACE
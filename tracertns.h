@@ -0,0 +1,37 @@
+#ifndef TRACERTNS_H
+#define TRACERTNS_H
+
+#include "stdint.h"
+
+// Binary event trace: a ring of one word entries kept through a warm reset and dumped by the 't' command (see
+// tracertns.c). Define TRACE to build it in; without it TRACE_RECORD() compiles to nothing.
+// #define TRACE
+
+// Entries in the ring; must be a power of two. Each entry is one word of RAM.
+#define TRACE_ENTRIES           512
+
+typedef enum
+{
+    TRACE_GAP = 0,              // the next entry is delta * 65536 ms later than its own delta says
+    TRACE_RESET,                // TraceInit(); payload: RESC bits 7:0 (see Register 11: Reset Cause)
+    TRACE_EDGE,                 // GPIOF_Handler; payload: GPIOF MIS
+    TRACE_DEBOUNCE,             // WTIMER0B_Handler
+    TRACE_TICK,                 // WTIMER0A_Handler (a software timer is due)
+    TRACE_EVENT,                // dispatch(); payload: ui_event_t
+    TRACE_STATE,                // display state change; payload: the new state
+    TRACE_LED                   // led pattern step; payload: led_pattern_t
+} trace_id_t;
+
+#ifdef TRACE
+#define TRACE_RECORD(id, payload)   TraceRecord((id), (payload))
+#else
+#define TRACE_RECORD(id, payload)
+#endif
+
+void TraceInit                  (void);
+void TraceRecord                (const trace_id_t id,
+                                 const uint32_t payload);
+void TraceDump                  (void);
+uint32_t TraceService           (void);
+
+#endif // TRACERTNS_H
@@ -1,18 +1,702 @@
 #include "TM4C123GH6PM.h"
 
+#include "benchrtns.h"
+#include "gpiortns.h"
 #include "uartrtns.h"
 
-void UartEnable(const uart_pin_t pin)
+#define UART_TX_BUFFER_MASK     (UART_TX_BUFFER_SZ - 1)
+#define UART_RX_BUFFER_MASK     (UART_RX_BUFFER_SZ - 1)
+
+#if (UART_TX_BUFFER_SZ & UART_TX_BUFFER_MASK) != 0
+#error "UART_TX_BUFFER_SZ must be a power of two"
+#endif
+#if (UART_RX_BUFFER_SZ & UART_RX_BUFFER_MASK) != 0
+#error "UART_RX_BUFFER_SZ must be a power of two"
+#endif
+
+#define UART_CTL_UARTEN         (1U << 0)       // UARTCTL: UART enable
+#define UART_CTL_TXE            (1U << 8)       // UARTCTL: transmit enable
+#define UART_CTL_RXE            (1U << 9)       // UARTCTL: receive enable
+#define UART_FR_BUSY            (1U << 3)       // UARTFR: transmitting
+#define UART_FR_RXFE            (1U << 4)       // UARTFR: receive FIFO empty
+#define UART_FR_TXFF            (1U << 5)       // UARTFR: transmit FIFO full
+#define UART_LCRH_FEN           (1U << 4)       // UARTLCRH: enable FIFOs
+#define UART_LCRH_WLEN_8        (0x3U << 5)     // UARTLCRH: 8 data bits (no parity, one stop bit)
+#define UART_INT_RX             (1U << 4)       // UARTIM/UARTMIS/UARTICR: receive interrupt
+#define UART_INT_TX             (1U << 5)       // UARTIM/UARTMIS/UARTICR: transmit interrupt
+#define UART_INT_RT             (1U << 6)       // UARTIM/UARTMIS/UARTICR: receive time-out interrupt
+
+// Baud rate divisors (UARTCC selects the system clock). BRD = clock / (16 * baud); IBRD is the integer part and
+// FBRD the fraction in 64ths, rounded (see 14.3.2 Baud-Rate Generation). For 9600 baud this gives IBRD=104,
+// FBRD=11 at 16MHz and IBRD=520, FBRD=53 at 80MHz. The preprocessor does the division, once per profile.
+#define UART_BRD(clockHz, baud)     (((clockHz) * 4 + (baud) / 2) / (baud))     // BRD * 64, rounded
+#define UART_IBRD(clockHz, baud)    (UART_BRD(clockHz, baud) >> 6)
+#define UART_FBRD(clockHz, baud)    (UART_BRD(clockHz, baud) & 0x3F)
+
+// Everything UartInit() needs to know about an instance. regs is 0 for an instance that is not built in.
+typedef struct
+{
+    UART0_Type *  regs;
+    gpio_port_t   port;
+    GPIOA_Type *  gpio;
+    uint32_t      pins;                         // Rx and Tx
+    uint32_t      pctlMask;                     // their GPIOPCTL fields
+    uint32_t      pctl;                         // PMCn = 1 for both
+    uint32_t      nvicWord;                     // ISER/ICER register of the interrupt number
+    uint32_t      nvicBit;
+    char *        rxBuffer;
+    char *        txBuffer;
+    uint16_t      ibrd[CLOCK_PROFILE_COUNT];    // indexed by clock_profile_t
+    uint8_t       fbrd[CLOCK_PROFILE_COUNT];
+} uart_config_t;
+
+// One entry of Config[]. On every instance Tx is the pin after Rx and both are PMCn = 1 (Table 23-5).
+#define UART_CONFIG(n, port, gpio, rxPin, irq)                                                  \
+    { UART##n, port, gpio, 0x3U << (rxPin), 0xFFU << ((rxPin) * 4), 0x11U << ((rxPin) * 4),    \
+      (irq) / 32, 1U << ((irq) % 32), Uart##n##Rx, Uart##n##Tx,                                 \
+      { UART_IBRD(CLOCK_16MHZ_HZ, UART##n##_BAUD), UART_IBRD(CLOCK_80MHZ_HZ, UART##n##_BAUD) },  \
+      { UART_FBRD(CLOCK_16MHZ_HZ, UART##n##_BAUD), UART_FBRD(CLOCK_80MHZ_HZ, UART##n##_BAUD) } }
+#define UART_UNUSED             { 0 }
+
+// A slower clock gives a smaller divisor, so checking the 16MHz one is enough.
+#ifdef UART0_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART0_BAUD) == 0
+#error "UART0_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart0Rx[UART_RX_BUFFER_SZ];
+static char Uart0Tx[UART_TX_BUFFER_SZ];
+#define UART0_CONFIG            UART_CONFIG(0, PORT_A, GPIO_PORTA, 0, 5)
+#else
+#define UART0_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART1_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART1_BAUD) == 0
+#error "UART1_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart1Rx[UART_RX_BUFFER_SZ];
+static char Uart1Tx[UART_TX_BUFFER_SZ];
+#define UART1_CONFIG            UART_CONFIG(1, PORT_B, GPIO_PORTB, 0, 6)
+#else
+#define UART1_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART2_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART2_BAUD) == 0
+#error "UART2_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart2Rx[UART_RX_BUFFER_SZ];
+static char Uart2Tx[UART_TX_BUFFER_SZ];
+#define UART2_CONFIG            UART_CONFIG(2, PORT_D, GPIO_PORTD, 6, 33)
+#else
+#define UART2_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART3_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART3_BAUD) == 0
+#error "UART3_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart3Rx[UART_RX_BUFFER_SZ];
+static char Uart3Tx[UART_TX_BUFFER_SZ];
+#define UART3_CONFIG            UART_CONFIG(3, PORT_C, GPIO_PORTC, 6, 59)
+#else
+#define UART3_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART4_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART4_BAUD) == 0
+#error "UART4_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart4Rx[UART_RX_BUFFER_SZ];
+static char Uart4Tx[UART_TX_BUFFER_SZ];
+#define UART4_CONFIG            UART_CONFIG(4, PORT_C, GPIO_PORTC, 4, 60)
+#else
+#define UART4_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART5_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART5_BAUD) == 0
+#error "UART5_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart5Rx[UART_RX_BUFFER_SZ];
+static char Uart5Tx[UART_TX_BUFFER_SZ];
+#define UART5_CONFIG            UART_CONFIG(5, PORT_E, GPIO_PORTE, 4, 61)
+#else
+#define UART5_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART6_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART6_BAUD) == 0
+#error "UART6_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart6Rx[UART_RX_BUFFER_SZ];
+static char Uart6Tx[UART_TX_BUFFER_SZ];
+#define UART6_CONFIG            UART_CONFIG(6, PORT_D, GPIO_PORTD, 4, 62)
+#else
+#define UART6_CONFIG            UART_UNUSED
+#endif
+
+#ifdef UART7_BAUD
+#if UART_IBRD(CLOCK_16MHZ_HZ, UART7_BAUD) == 0
+#error "UART7_BAUD is too high for a 16MHz clock"
+#endif
+static char Uart7Rx[UART_RX_BUFFER_SZ];
+static char Uart7Tx[UART_TX_BUFFER_SZ];
+#define UART7_CONFIG            UART_CONFIG(7, PORT_E, GPIO_PORTE, 0, 63)
+#else
+#define UART7_CONFIG            UART_UNUSED
+#endif
+
+// Indexed by uart_pin_t; the interrupt numbers are from startup_TM4C123.s.
+static const uart_config_t Config[UART_COUNT] =
+{
+    UART0_CONFIG,               // PA0/PA1, interrupt 5
+    UART1_CONFIG,               // PB0/PB1, interrupt 6
+    UART2_CONFIG,               // PD6/PD7, interrupt 33
+    UART3_CONFIG,               // PC6/PC7, interrupt 59
+    UART4_CONFIG,               // PC4/PC5, interrupt 60
+    UART5_CONFIG,               // PE4/PE5, interrupt 61
+    UART6_CONFIG,               // PD4/PD5, interrupt 62
+    UART7_CONFIG                // PE0/PE1, interrupt 63
+};
+
+// Ring buffer indices of an instance. They run freely and are masked on use. rxHead and txTail are only
+// moved by the instance's interrupt handler (txTail also by the writer while the interrupt is masked),
+// rxTail and txHead only by the reader and writer.
+typedef struct
+{
+    volatile uint32_t rxHead;
+    volatile uint32_t rxTail;
+    volatile uint32_t rxDropped;
+    volatile uint32_t rxHighWater;      // most characters the ring has held
+    volatile uint32_t txHead;
+    volatile uint32_t txTail;
+    volatile uint32_t txDropped;
+    volatile uint32_t txHighWater;
+    uart_tx_policy_t  txPolicy;
+} uart_state_t;
+
+static uart_state_t State[UART_COUNT];
+
+// The instance the routines work on: Config[] and State[] are only indexed through this. With one instance built
+// in (as with just UART0_BAUD) every call can only be for it, so the index is a constant whatever the caller
+// passes, and the entry's registers, buffers and NVIC bits fold into the code as if written for that instance.
+// With more than one the argument selects the entry at run time: one indexed load from the table in flash.
+#if defined(UART0_BAUD) + defined(UART1_BAUD) + defined(UART2_BAUD) + defined(UART3_BAUD) + \
+    defined(UART4_BAUD) + defined(UART5_BAUD) + defined(UART6_BAUD) + defined(UART7_BAUD) == 1
+#if defined(UART0_BAUD)
+#define UART_SOLE               UART_0
+#elif defined(UART1_BAUD)
+#define UART_SOLE               UART_1
+#elif defined(UART2_BAUD)
+#define UART_SOLE               UART_2
+#elif defined(UART3_BAUD)
+#define UART_SOLE               UART_3
+#elif defined(UART4_BAUD)
+#define UART_SOLE               UART_4
+#elif defined(UART5_BAUD)
+#define UART_SOLE               UART_5
+#elif defined(UART6_BAUD)
+#define UART_SOLE               UART_6
+#else
+#define UART_SOLE               UART_7
+#endif
+#define UART_INSTANCE(uart)     ((void)(uart), UART_SOLE)
+#else
+#define UART_INSTANCE(uart)     (uart)
+#endif
+
+#ifdef UART_TX_DMA
+#ifndef UART0_BAUD
+#error "UART_TX_DMA sends on UART0"
+#endif
+#if UART_TX_BUFFER_SZ > 1024
+#error "A single uDMA transfer is limited to 1024 items"
+#endif
+
+#define UART0_TX_DMA_CHANNEL    9               // Channel 9, encoding 0 is UART0 TX (see Table 9-1)
+
+// uDMA channel control structure (see 9.2.5 Channel Configuration). The table must be 1024 byte
+// aligned; we only use the primary structures up to channel 9.
+typedef struct
 {
+    volatile uint32_t srcEnd;
+    volatile uint32_t dstEnd;
+    volatile uint32_t control;
+    uint32_t          spare;
+} dma_control_t;
+
+static dma_control_t DmaControlTable[UART0_TX_DMA_CHANNEL + 1] __attribute__((aligned(1024)));
+
+// Number of UART0 characters handed to the uDMA; 0 when the uDMA is idle.
+static volatile uint32_t TxDmaCount;
+
+static void setupDma(void);
+static void startDma(void);
+#endif
+
+static uint32_t makeRoom(const uart_pin_t uart);
+static void primeTransmit(const uart_pin_t uart);
+static void fillTransmitter(const uart_pin_t uart);
+
+void UartEnable(const uart_pin_t uart)
+{
+    if (SYSCTL->PRUART & (1 << uart))
+        return;
     // Disable clock gating for UART. See page 656 (Initialisation and Configuration step 1) and
     // page 344 (Register 63).
-    SYSCTL->RCGCUART |= (1 << pin);
+    SYSCTL->RCGCUART |= (1 << uart);
 
     // There must be a delay of 3 system clocks after a peripheral module clock is enabled in the UART register
     // before any module registers are accessed. See page 227 (System Control). We check PRUART; see page 410.
     while (1)
     {
-        if (SYSCTL->PRUART & (1 << pin))
+        if (SYSCTL->PRUART & (1 << uart))
             break;
     }
 }
+
+// Set up an instance from its Config[] entry, following 14.4 Initialization and Configuration: the clocks, the
+// pins, the divisors for ClockProfile(), 8 data bits with no parity and one stop bit, the 16 byte FIFOs with the
+// given trigger levels, the receive interrupts and the NVIC. Does nothing for an instance without UARTn_BAUD.
+// With the FIFOs enabled a receive interrupt needs rxLevel characters; the receive time-out interrupt
+// (32 bit periods without a new character) picks up a shorter burst.
+void UartInit(const uart_pin_t uart,
+              const uart_fifo_level_t rxLevel,
+              const uart_fifo_level_t txLevel,
+              const uart_tx_policy_t policy)
+{
+    const uart_config_t * const config = &Config[UART_INSTANCE(uart)];
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+    UART0_Type * const regs = config->regs;
+    GPIOA_Type * const gpio = config->gpio;
+    clock_profile_t profile = ClockProfile();
+
+    if (regs == 0)
+        return;
+
+    // 1. and 2. The UART and its GPIO port
+    UartEnable(uart);
+    GpioEnable(config->port, GPIO_APERTURE);
+
+    // 3. to 5. Alternate function (GPIOAFSEL, GPIOPCTL PMCn) and digital enable. PD7 (U2Tx) is locked like
+    // PF0, so commit the pins first; GPIOCR has no effect on the other pins.
+    gpio->LOCK   = GPIO_LOCK_KEY;
+    gpio->CR    |= config->pins;
+    gpio->LOCK   = 0;
+    gpio->AFSEL |= config->pins;
+    gpio->PCTL   = (gpio->PCTL & ~config->pctlMask) | config->pctl;
+    gpio->DEN   |= config->pins;
+
+    // UARTLCRH must not be changed while the UART is enabled, and the divisors only take effect after a write
+    // to UARTLCRH (see Register 8: UARTIBRD).
+    regs->CTL  &= ~UART_CTL_UARTEN;
+    regs->CC    = 0x0;
+    regs->IBRD  = config->ibrd[profile];
+    regs->FBRD  = config->fbrd[profile];
+    regs->LCRH  = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
+    regs->IFLS  = (rxLevel << 3) | (txLevel << 0);
+    regs->ICR   = UART_INT_RX | UART_INT_RT | UART_INT_TX;
+    regs->IM    = UART_INT_RX | UART_INT_RT;
+
+    state->rxHead = state->rxTail = 0;
+    state->rxDropped = state->rxHighWater = 0;
+    state->txHead = state->txTail = 0;
+    state->txDropped = state->txHighWater = 0;
+    state->txPolicy = policy;
+#ifdef UART_TX_DMA
+    if (uart == UART_0)
+        setupDma();
+#endif
+
+    regs->CTL = UART_CTL_UARTEN | UART_CTL_TXE | UART_CTL_RXE;
+    NVIC->ISER[config->nvicWord] = config->nvicBit;
+}
+
+// Switch every configured instance to the divisors for a new system clock. The UART finishes the character in
+// progress once disabled; the FIFO contents are kept.
+void UartSetClock(const clock_profile_t profile)
+{
+    uint32_t i;
+
+    for (i = 0; i < UART_COUNT; i++)
+    {
+        UART0_Type * const regs = Config[i].regs;
+        uint32_t ctl;
+
+        if (regs == 0 || (SYSCTL->PRUART & (1 << i)) == 0)
+            continue;
+
+        ctl = regs->CTL;
+        regs->CTL = ctl & ~UART_CTL_UARTEN;
+        while (regs->FR & UART_FR_BUSY);
+
+        regs->IBRD = Config[i].ibrd[profile];
+        regs->FBRD = Config[i].fbrd[profile];
+        regs->LCRH = regs->LCRH;
+        regs->CTL  = ctl;
+    }
+}
+
+// Returns 1 and the oldest received character, or 0 if nothing has been received.
+uint32_t UartRxRead(const uart_pin_t uart,
+                    char * const c)
+{
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+
+    if (state->rxTail == state->rxHead)
+        return 0;
+
+    *c = Config[UART_INSTANCE(uart)].rxBuffer[state->rxTail & UART_RX_BUFFER_MASK];
+    state->rxTail++;
+    return 1;
+}
+
+uint32_t UartRxAvailable(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].rxHead - State[UART_INSTANCE(uart)].rxTail;
+}
+
+// Called from the instance's interrupt handler; empties the receive FIFO in one go. Characters that do not fit
+// in the ring buffer are counted and discarded.
+void UartRxHandler(const uart_pin_t uart)
+{
+    UART0_Type * const regs = Config[UART_INSTANCE(uart)].regs;
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+
+    if ((regs->MIS & (UART_INT_RX | UART_INT_RT)) == 0)
+        return;
+
+    regs->ICR = UART_INT_RX | UART_INT_RT;
+
+    while ((regs->FR & UART_FR_RXFE) == 0)
+    {
+        char c = (char)(regs->DR & 0xFF);     // bits 11:8 are the error flags
+        uint32_t used = state->rxHead - state->rxTail;
+
+        if (used < UART_RX_BUFFER_SZ)
+        {
+            Config[UART_INSTANCE(uart)].rxBuffer[state->rxHead & UART_RX_BUFFER_MASK] = c;
+            state->rxHead++;
+            if (used + 1 > state->rxHighWater)
+                state->rxHighWater = used + 1;
+        }
+        else
+        {
+            state->rxDropped++;
+        }
+    }
+}
+
+uint32_t UartRxDropped(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].rxDropped;
+}
+
+uint32_t UartRxHighWater(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].rxHighWater;
+}
+
+void UartTxWriteChar(const uart_pin_t uart,
+                     const char c)
+{
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+
+    if (makeRoom(uart))
+    {
+        Config[UART_INSTANCE(uart)].txBuffer[state->txHead & UART_TX_BUFFER_MASK] = c;
+        state->txHead++;
+    }
+    primeTransmit(uart);
+}
+
+// Queue a string for transmission and return without waiting for it to be sent.
+void UartTxWrite(const uart_pin_t uart,
+                 const char * string)
+{
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+    char * const buffer = Config[UART_INSTANCE(uart)].txBuffer;
+
+    while (*string)
+    {
+        if (makeRoom(uart))
+        {
+            buffer[state->txHead & UART_TX_BUFFER_MASK] = *string;
+            state->txHead++;
+        }
+        string++;
+    }
+    primeTransmit(uart);
+}
+
+// As UartTxWrite(), for length characters that may include NULs (e.g. a binary frame).
+void UartTxWriteBytes(const uart_pin_t uart,
+                      const char * const data,
+                      const uint32_t length)
+{
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+    char * const buffer = Config[UART_INSTANCE(uart)].txBuffer;
+    uint32_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (makeRoom(uart))
+        {
+            buffer[state->txHead & UART_TX_BUFFER_MASK] = data[i];
+            state->txHead++;
+        }
+    }
+    primeTransmit(uart);
+}
+
+// Called from the instance's interrupt handler for every interrupt.
+void UartTxHandler(const uart_pin_t uart)
+{
+    UART0_Type * const regs = Config[UART_INSTANCE(uart)].regs;
+
+#ifdef UART_TX_DMA
+    // uDMA completion is signalled on the UART0 interrupt vector (see 9.2.9 Interrupts and Errors)
+    if (uart == UART_0 && (UDMA->CHIS & (1U << UART0_TX_DMA_CHANNEL)))
+    {
+        UDMA->CHIS = (1U << UART0_TX_DMA_CHANNEL);
+        State[UART_0].txTail += TxDmaCount;
+        TxDmaCount = 0;
+    }
+#endif
+    if (regs->MIS & UART_INT_TX)
+        regs->ICR = UART_INT_TX;
+
+    fillTransmitter(uart);
+}
+
+uint32_t UartTxDropped(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].txDropped;
+}
+
+uint32_t UartTxHighWater(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].txHighWater;
+}
+
+// Characters that can be written before the ring buffer is full
+uint32_t UartTxSpace(const uart_pin_t uart)
+{
+    return UART_TX_BUFFER_SZ - (State[UART_INSTANCE(uart)].txHead - State[UART_INSTANCE(uart)].txTail);
+}
+
+// Characters written to the ring buffer since UartInit(), wrapping at 2^32: the position the next one will take
+uint32_t UartTxQueued(const uart_pin_t uart)
+{
+    return State[UART_INSTANCE(uart)].txHead;
+}
+
+// UART0_Handler is in main.c; the handlers of the other instances only move the ring buffers.
+#ifdef UART1_BAUD
+void UART1_Handler(void)
+{
+    UartRxHandler(UART_1);
+    UartTxHandler(UART_1);
+}
+#endif
+
+#ifdef UART2_BAUD
+void UART2_Handler(void)
+{
+    UartRxHandler(UART_2);
+    UartTxHandler(UART_2);
+}
+#endif
+
+#ifdef UART3_BAUD
+void UART3_Handler(void)
+{
+    UartRxHandler(UART_3);
+    UartTxHandler(UART_3);
+}
+#endif
+
+#ifdef UART4_BAUD
+void UART4_Handler(void)
+{
+    UartRxHandler(UART_4);
+    UartTxHandler(UART_4);
+}
+#endif
+
+#ifdef UART5_BAUD
+void UART5_Handler(void)
+{
+    UartRxHandler(UART_5);
+    UartTxHandler(UART_5);
+}
+#endif
+
+#ifdef UART6_BAUD
+void UART6_Handler(void)
+{
+    UartRxHandler(UART_6);
+    UartTxHandler(UART_6);
+}
+#endif
+
+#ifdef UART7_BAUD
+void UART7_Handler(void)
+{
+    UartRxHandler(UART_7);
+    UartTxHandler(UART_7);
+}
+#endif
+
+// Apply the overflow policy if the ring buffer is full. Returns 1 if the next character can be stored, and
+// counts it towards the high-water mark.
+static uint32_t makeRoom(const uart_pin_t uart)
+{
+    const uart_config_t * const config = &Config[UART_INSTANCE(uart)];
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+    uint32_t used = state->txHead - state->txTail;
+    uint32_t room = 0;
+
+    if (used < UART_TX_BUFFER_SZ)
+    {
+        if (used + 1 > state->txHighWater)
+            state->txHighWater = used + 1;
+        return 1;
+    }
+    state->txHighWater = UART_TX_BUFFER_SZ;
+
+    switch (state->txPolicy)
+    {
+    case UART_TX_BLOCK:
+        // Make sure the transmitter is running, then wait for the interrupt handler to free a slot
+        primeTransmit(uart);
+        while (state->txHead - state->txTail >= UART_TX_BUFFER_SZ);
+        room = 1;
+        break;
+
+    case UART_TX_DROP_OLDEST:
+        // Mask the instance so that txTail cannot move underneath us. Characters already handed
+        // to the uDMA cannot be taken back, so in that case we drop the new character instead.
+        NVIC->ICER[config->nvicWord] = config->nvicBit;
+        __DSB();
+        __ISB();
+#ifdef UART_TX_DMA
+        if (uart != UART_0 || TxDmaCount == 0)
+#endif
+        {
+            if (state->txHead - state->txTail >= UART_TX_BUFFER_SZ)
+                state->txTail++;
+            room = 1;
+        }
+        NVIC->ISER[config->nvicWord] = config->nvicBit;
+        state->txDropped++;
+        break;
+
+    case UART_TX_DROP_NEWEST:
+    default:
+        state->txDropped++;
+        break;
+    }
+
+    return room;
+}
+
+// Start the transmitter from thread level. The instance is masked in the NVIC so that we do not race
+// its interrupt handler for txTail or UARTIM.
+static void primeTransmit(const uart_pin_t uart)
+{
+    const uart_config_t * const config = &Config[UART_INSTANCE(uart)];
+
+    NVIC->ICER[config->nvicWord] = config->nvicBit;
+    __DSB();
+    __ISB();
+    fillTransmitter(uart);
+    NVIC->ISER[config->nvicWord] = config->nvicBit;
+}
+
+// Move characters from the ring buffer to the UART. The TX interrupt is only unmasked while there is
+// something left to send; it fires when the transmit FIFO drains to the UARTIFLS level (see UARTRIS TXRIS).
+static void fillTransmitter(const uart_pin_t uart)
+{
+    UART0_Type * const regs = Config[UART_INSTANCE(uart)].regs;
+    char * const buffer = Config[UART_INSTANCE(uart)].txBuffer;
+    uart_state_t * const state = &State[UART_INSTANCE(uart)];
+
+#ifdef UART_TX_DMA
+    if (uart == UART_0)
+    {
+        if (TxDmaCount != 0)
+            return;     // the uDMA owns the transmitter until its completion interrupt
+
+        if (state->txHead - state->txTail >= UART_TX_DMA_THRESHOLD)
+        {
+            startDma();
+            return;
+        }
+    }
+#endif
+
+    while (state->txTail != state->txHead && (regs->FR & UART_FR_TXFF) == 0)
+    {
+#ifdef BENCHMARK
+        if (uart == UART_0)
+            BenchTransmit(state->txTail, 1);
+#endif
+        regs->DR = buffer[state->txTail & UART_TX_BUFFER_MASK];
+        state->txTail++;
+    }
+
+    if (state->txTail != state->txHead)
+        regs->IM |= UART_INT_TX;
+    else
+        regs->IM &= ~UART_INT_TX;
+}
+
+#ifdef UART_TX_DMA
+static void setupDma(void)
+{
+    // Enable the uDMA clock (RCGCDMA) and wait for PRDMA, as per UartEnable().
+    SYSCTL->RCGCDMA |= (1 << 0);
+    while ((SYSCTL->PRDMA & (1 << 0)) == 0);
+
+    UDMA->CFG     = (1 << 0);                                   // MASTEN
+    UDMA->CTLBASE = (uint32_t)DmaControlTable;
+
+    UDMA->CHMAP1      &= ~(0xFU << ((UART0_TX_DMA_CHANNEL - 8) * 4)); // encoding 0: UART0 TX
+    UDMA->PRIOCLR     = (1U << UART0_TX_DMA_CHANNEL);           // default priority
+    UDMA->ALTCLR      = (1U << UART0_TX_DMA_CHANNEL);           // primary control structure
+    UDMA->USEBURSTCLR = (1U << UART0_TX_DMA_CHANNEL);           // single and burst requests
+    UDMA->REQMASKCLR  = (1U << UART0_TX_DMA_CHANNEL);
+
+    UART0->DMACTL |= (1 << 1);                                  // TXDMAE
+}
+
+// Hand the oldest contiguous run of the UART0 ring buffer to the uDMA (basic mode, byte to UARTDR).
+static void startDma(void)
+{
+    uart_state_t * const state = &State[UART_0];
+    uint32_t start = state->txTail & UART_TX_BUFFER_MASK;
+    uint32_t count = state->txHead - state->txTail;
+
+    if (count > UART_TX_BUFFER_SZ - start)
+        count = UART_TX_BUFFER_SZ - start;  // stop at the end of the ring; the rest goes next time
+
+    DmaControlTable[UART0_TX_DMA_CHANNEL].srcEnd  = (uint32_t)&Uart0Tx[start + count - 1];
+    DmaControlTable[UART0_TX_DMA_CHANNEL].dstEnd  = (uint32_t)&UART0->DR;
+    DmaControlTable[UART0_TX_DMA_CHANNEL].control = (0x3U << 30) |          // DSTINC: no increment
+                                                    (0x0U << 28) |          // DSTSIZE: byte
+                                                    (0x0U << 26) |          // SRCINC: byte
+                                                    (0x0U << 24) |          // SRCSIZE: byte
+                                                    (0x2U << 14) |          // ARBSIZE: 4 transfers
+                                                    ((count - 1) << 4) |    // XFERSIZE
+                                                    (0x1U << 0);            // XFERMODE: basic
+    TxDmaCount = count;
+#ifdef BENCHMARK
+    BenchTransmit(state->txTail, count);
+#endif
+
+    UART0->IM &= ~UART_INT_TX;
+    UDMA->ENASET = (1U << UART0_TX_DMA_CHANNEL);
+}
+#endif
@@ -3,6 +3,9 @@
 
 #include "stdint.h"
 
+#include "clockrtns.h"
+#include "gpiortns.h"
+
 typedef enum
 {
     UART_0 = 0,
@@ -15,6 +18,140 @@ typedef enum
     UART_7
 } uart_pin_t;
 
-void UartEnable                 (const uart_pin_t pin);
+#define UART_COUNT              8
+
+// What UartTxWrite() does when the transmit ring buffer is full
+typedef enum
+{
+    UART_TX_DROP_NEWEST = 0,    // discard the character being written
+    UART_TX_DROP_OLDEST,        // discard the oldest character not yet sent
+    UART_TX_BLOCK               // wait for the TX interrupt to make room; never use from an ISR
+} uart_tx_policy_t;
+
+// FIFO trigger levels for UARTIFLS. The RX interrupt fires when the receive FIFO fills to the level,
+// the TX interrupt when the transmit FIFO drains to the level.
+typedef enum
+{
+    UART_FIFO_1_8 = 0,          // 2 of 16 characters
+    UART_FIFO_1_4,              // 4 of 16
+    UART_FIFO_1_2,              // 8 of 16
+    UART_FIFO_3_4,              // 12 of 16
+    UART_FIFO_7_8               // 14 of 16
+} uart_fifo_level_t;
+
+// Transmit and receive ring buffers of each instance; the sizes must be powers of two.
+#define UART_TX_BUFFER_SZ       128
+#define UART_RX_BUFFER_SZ       64
+
+// Define UART_TX_DMA to let uDMA channel 9 send UART0 strings of at least UART_TX_DMA_THRESHOLD characters.
+// #define UART_TX_DMA
+#define UART_TX_DMA_THRESHOLD   16
+
+// Instances: define UARTn_BAUD to build in UART n, its ring buffers and (for n > 0) its interrupt handler. The
+// divisors for every clock profile, the pins and the NVIC bits are worked out at compile time (see uartrtns.c).
+// With one instance built in the routines ignore their uart argument and work on it directly; with more they
+// look the instance up at run time.
+// main.c only sets up UART0; for n > 0 the application calls UartInit(UART_n, ...) itself once the module and
+// its port are clocked (UART_BUILT_MASK and UART_PORT_MASK are in main.c's Peripherals).
+// Rx/Tx pins (Table 23-5): UART0 PA0/PA1, UART1 PB0/PB1, UART2 PD6/PD7, UART3 PC6/PC7, UART4 PC4/PC5,
+// UART5 PE4/PE5, UART6 PD4/PD5, UART7 PE0/PE1.
+#define UART0_BAUD              9600
+// #define UART1_BAUD           115200
+// #define UART2_BAUD           9600
+// #define UART3_BAUD           9600
+// #define UART4_BAUD           9600
+// #define UART5_BAUD           9600
+// #define UART6_BAUD           9600
+// #define UART7_BAUD           9600
+
+// The instances built in, as a periph_mask_t uart mask, and the GPIO ports of their pins as a gpio mask
+#ifdef UART0_BAUD
+#define UART0_BUILT             (1U << UART_0)
+#define UART0_PORT              (1U << PORT_A)
+#else
+#define UART0_BUILT             0
+#define UART0_PORT              0
+#endif
+#ifdef UART1_BAUD
+#define UART1_BUILT             (1U << UART_1)
+#define UART1_PORT              (1U << PORT_B)
+#else
+#define UART1_BUILT             0
+#define UART1_PORT              0
+#endif
+#ifdef UART2_BAUD
+#define UART2_BUILT             (1U << UART_2)
+#define UART2_PORT              (1U << PORT_D)
+#else
+#define UART2_BUILT             0
+#define UART2_PORT              0
+#endif
+#ifdef UART3_BAUD
+#define UART3_BUILT             (1U << UART_3)
+#define UART3_PORT              (1U << PORT_C)
+#else
+#define UART3_BUILT             0
+#define UART3_PORT              0
+#endif
+#ifdef UART4_BAUD
+#define UART4_BUILT             (1U << UART_4)
+#define UART4_PORT              (1U << PORT_C)
+#else
+#define UART4_BUILT             0
+#define UART4_PORT              0
+#endif
+#ifdef UART5_BAUD
+#define UART5_BUILT             (1U << UART_5)
+#define UART5_PORT              (1U << PORT_E)
+#else
+#define UART5_BUILT             0
+#define UART5_PORT              0
+#endif
+#ifdef UART6_BAUD
+#define UART6_BUILT             (1U << UART_6)
+#define UART6_PORT              (1U << PORT_D)
+#else
+#define UART6_BUILT             0
+#define UART6_PORT              0
+#endif
+#ifdef UART7_BAUD
+#define UART7_BUILT             (1U << UART_7)
+#define UART7_PORT              (1U << PORT_E)
+#else
+#define UART7_BUILT             0
+#define UART7_PORT              0
+#endif
+
+#define UART_BUILT_MASK         (UART0_BUILT | UART1_BUILT | UART2_BUILT | UART3_BUILT |  \
+                                 UART4_BUILT | UART5_BUILT | UART6_BUILT | UART7_BUILT)
+#define UART_PORT_MASK          (UART0_PORT | UART1_PORT | UART2_PORT | UART3_PORT |      \
+                                 UART4_PORT | UART5_PORT | UART6_PORT | UART7_PORT)
+
+void UartEnable                 (const uart_pin_t uart);
+void UartInit                   (const uart_pin_t uart,
+                                 const uart_fifo_level_t rxLevel,
+                                 const uart_fifo_level_t txLevel,
+                                 const uart_tx_policy_t policy);
+void UartSetClock               (const clock_profile_t profile);
+
+uint32_t UartRxRead             (const uart_pin_t uart,
+                                 char * const c);
+uint32_t UartRxAvailable        (const uart_pin_t uart);
+void UartRxHandler              (const uart_pin_t uart);
+uint32_t UartRxDropped          (const uart_pin_t uart);
+uint32_t UartRxHighWater        (const uart_pin_t uart);
+
+void UartTxWriteChar            (const uart_pin_t uart,
+                                 const char c);
+void UartTxWrite                (const uart_pin_t uart,
+                                 const char * string);
+void UartTxWriteBytes           (const uart_pin_t uart,
+                                 const char * const data,
+                                 const uint32_t length);
+void UartTxHandler              (const uart_pin_t uart);
+uint32_t UartTxDropped          (const uart_pin_t uart);
+uint32_t UartTxHighWater        (const uart_pin_t uart);
+uint32_t UartTxSpace            (const uart_pin_t uart);
+uint32_t UartTxQueued           (const uart_pin_t uart);
 
 #endif // UARTRTNS_H